@@ -71,6 +71,18 @@ TableSettings const &TableSettings::getDefault()
 	return singleton;
 }
 
+HeatmapSettings const &HeatmapSettings::getDefault()
+{
+	static HeatmapSettings const singleton {
+		{ // dark blue, cyan, yellow, red
+			sf::Color(0, 0, 128), sf::Color(0, 255, 255),
+			sf::Color(255, 255, 0), sf::Color(255, 0, 0)
+		},
+		true, 40.0f
+	};
+	return singleton;
+}
+
 
 
 
@@ -129,12 +141,20 @@ void ChartPrinter::drawTable(
 ) const
 {
 	states.transform *= sf::Transformable::getTransform();
-	char buf[32];
+	char buf[48];
 	pixpoint = pixelsToDescartes(pixpoint);
 	std::snprintf(buf, sizeof buf, "%6g, %6g",
 		float(int(100 * pixpoint.x))/100.0f,
 		float(int(100 * pixpoint.y))/100.0f
 	);
+
+	// value of heatmap cell under cursor
+	float value;
+	if(getHeatmapValue(descartesToPixels(pixpoint), value)) {
+		size_t const length = std::strlen(buf);
+		std::snprintf(buf + length, sizeof buf - length, ": %6g", value);
+	}
+
 	tabset_.text.setString(buf);
 	tabset_.text.setPosition({
 		width_ - ( tabset_.text.getLocalBounds().width + tabset_.padding.x ),
@@ -225,6 +245,52 @@ ChartPrinter &ChartPrinter::clearCharts()
 
 
 
+// heatmap
+ChartPrinter &ChartPrinter::setHeatmap(
+	matrixptr_type matrix,
+	HeatmapSettings const &settings
+)
+{
+	heatmap_ = matrix;
+	heatset_ = settings;
+	ischanged_ = true;
+	return *this;
+}
+ChartPrinter &ChartPrinter::clearHeatmap()
+{
+	if(!heatmap_)
+		return *this;
+	heatmap_.reset();
+	ischanged_ = true;
+	return *this;
+}
+
+bool ChartPrinter::getHeatmapValue(
+	sf::Vector2f const &pixpoint, float &value
+) const
+{
+	if(!heatmap_)
+		return false;
+
+	sf::Vector2f const point = pixelsToDescartes(pixpoint);
+	std::vector<float> const xedges = cell_edges_(heatmap_->abscissa);
+	std::vector<float> const yedges = cell_edges_(heatmap_->ordinate);
+	auto const x = std::upper_bound(xedges.begin(), xedges.end(), point.x);
+	auto const y = std::upper_bound(yedges.begin(), yedges.end(), point.y);
+	if(
+		x == xedges.begin() || x == xedges.end() ||
+		y == yedges.begin() || y == yedges.end()
+	)
+		return false;
+
+	size_t const column = x - xedges.begin() - 1;
+	size_t const row = y - yedges.begin() - 1;
+	value = heatmap_->values[row * heatmap_->abscissa.size() + column];
+	return true;
+}
+
+
+
 // axis settings
 ChartPrinter &ChartPrinter::setAxisSettings(
 	AxisSettings const &newaxis
@@ -449,6 +515,28 @@ void ChartPrinter::calculate_charts_characts_()
 			ymax = buf->second;
 	}
 
+	// heatmap: cells and range of values
+	if(heatmap_ && !heatmap_->abscissa.empty() && !heatmap_->ordinate.empty()) {
+		std::vector<float> const xedges = cell_edges_(heatmap_->abscissa);
+		std::vector<float> const yedges = cell_edges_(heatmap_->ordinate);
+		xmin_ = std::min(xmin_, xedges.front());
+		xmax = std::max(xmax, xedges.back());
+		ymin_ = std::min(ymin_, yedges.front());
+		ymax = std::max(ymax, yedges.back());
+
+		vmin_ = vmax_ = 0.0f;
+		bool first = true;
+		for(float v : heatmap_->values) {
+			if(heatset_.logscale && v <= 0.0f)
+				continue;
+			if(first || v < vmin_)
+				vmin_ = v;
+			if(first || v > vmax_)
+				vmax_ = v;
+			first = false;
+		}
+	}
+
 	// calculate length
 	xl_ = xmax-xmin_;
 	yl_ = ymax-ymin_;
@@ -663,11 +751,13 @@ void ChartPrinter::draw_()
 	rtexture_.clear(sf::Color::Transparent);
 
 	// draw
+	draw_heatmap_();
 	if(gridset_.enable)
 		draw_grid_();
 	draw_axis_();
 	draw_tags_();
 	draw_charts_();
+	draw_scale_();
 
 	rtexture_.display();
 
@@ -890,6 +980,136 @@ void ChartPrinter::draw_charts_()
 	return;
 }
 
+void ChartPrinter::draw_heatmap_()
+{
+	if(!heatmap_ || xk_ == 0.0f || yk_ == 0.0f)
+		return;
+
+	std::vector<float> const xedges = cell_edges_(heatmap_->abscissa);
+	std::vector<float> const yedges = cell_edges_(heatmap_->ordinate);
+	size_t const columns = heatmap_->abscissa.size();
+
+	// one quad per cell
+	sf::VertexArray cells(sf::Quads);
+	for(size_t row = 0; row < heatmap_->ordinate.size(); ++row) {
+		for(size_t column = 0; column < columns; ++column) {
+			sf::Color const color = scale_color_(
+				heatmap_->values[row * columns + column]
+			);
+			sf::Vector2f const lt = descartesToPixels({
+				xedges[column], yedges[row+1]
+			});
+			sf::Vector2f const rb = descartesToPixels({
+				xedges[column+1], yedges[row]
+			});
+			cells.append(sf::Vertex(lt, color));
+			cells.append(sf::Vertex({rb.x, lt.y}, color));
+			cells.append(sf::Vertex(rb, color));
+			cells.append(sf::Vertex({lt.x, rb.y}, color));
+		}
+	}
+	rtexture_.draw(cells);
+
+	return;
+}
+
+void ChartPrinter::draw_scale_()
+{
+	if(!heatmap_ || heatset_.colors.empty() || vmax_ <= vmin_)
+		return;
+
+	// colour bar in the right padding, low values at the bottom
+	float const left = width_ - 0.5f*padding_;
+	float const right = left + heatset_.scalewidth;
+	float const top = padding_;
+	float const bottom = height_ - padding_;
+	constexpr static int const STEPS = 64;
+
+	sf::VertexArray bar(sf::Quads);
+	for(int i = 0; i < STEPS; ++i) {
+		float const t0 = float(i) / STEPS, t1 = float(i+1) / STEPS;
+		auto value = [this](float t) {
+			return heatset_.logscale ?
+				vmin_ * std::pow(vmax_/vmin_, t) :
+				vmin_ + (vmax_-vmin_) * t;
+		};
+		sf::Color const color = scale_color_(value(0.5f*(t0+t1)));
+		float const y0 = bottom - (bottom-top)*t0;
+		float const y1 = bottom - (bottom-top)*t1;
+		bar.append(sf::Vertex({left, y1}, color));
+		bar.append(sf::Vertex({right, y1}, color));
+		bar.append(sf::Vertex({right, y0}, color));
+		bar.append(sf::Vertex({left, y0}, color));
+	}
+	rtexture_.draw(bar);
+
+	// labels of minimum and maximum
+	char buf[24u];
+	float const values[] = { vmin_, vmax_ };
+	float const ys[] = { bottom, top };
+	for(int i = 0; i < 2; ++i) {
+		std::snprintf(buf, sizeof buf, "%.4g", values[i]);
+		tagset_.text.setString(buf);
+		tagset_.text.setPosition({
+			left - tagset_.text.getLocalBounds().width - tagset_.length*0.5f,
+			ys[i] - 0.5f*tagset_.text.getLocalBounds().height
+		});
+		rtexture_.draw(tagset_.text);
+	}
+
+	return;
+}
+
+
+
+// colour of value by heatmap scale
+sf::Color ChartPrinter::scale_color_(float value) const
+{
+	auto const &colors = heatset_.colors;
+	if(colors.empty())
+		return sf::Color::Transparent;
+	if(colors.size() == 1 || vmax_ <= vmin_)
+		return colors.front();
+	if(heatset_.logscale && value <= 0.0f)
+		return colors.front();
+
+	float t = heatset_.logscale ?
+		std::log(value/vmin_) / std::log(vmax_/vmin_) :
+		(value-vmin_) / (vmax_-vmin_);
+	t = std::min(1.0f, std::max(0.0f, t)) * (colors.size()-1);
+
+	size_t const i = std::min<size_t>(t, colors.size()-2);
+	float const f = t - i;
+	auto mix = [f](sf::Uint8 a, sf::Uint8 b) {
+		return sf::Uint8(a + (float(b) - float(a)) * f);
+	};
+	return sf::Color(
+		mix(colors[i].r, colors[i+1].r),
+		mix(colors[i].g, colors[i+1].g),
+		mix(colors[i].b, colors[i+1].b),
+		mix(colors[i].a, colors[i+1].a)
+	);
+}
+
+// cells borders are halfway between centers
+std::vector<float> ChartPrinter::cell_edges_(std::vector<float> const &centers)
+{
+	std::vector<float> edges;
+	if(centers.empty())
+		return edges;
+	if(centers.size() == 1)
+		return { centers[0] - 0.5f, centers[0] + 0.5f };
+
+	edges.push_back(centers[0] - 0.5f*(centers[1]-centers[0]));
+	for(size_t i = 1; i < centers.size(); ++i)
+		edges.push_back(0.5f*(centers[i-1]+centers[i]));
+	edges.push_back(
+		centers.back() + 0.5f*(centers.back()-centers[centers.size()-2])
+	);
+	return edges;
+}
+
+
 
 float ChartPrinter::make_beauty_(float n)
 {
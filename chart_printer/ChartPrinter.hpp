@@ -85,6 +85,25 @@ struct TableSettings
 };
 
 
+struct HeatmapSettings
+{
+	std::vector<sf::Color> colors; // colour scale, from low to high values
+	bool logscale;
+	float scalewidth; // width of colour bar, pixels
+
+	static HeatmapSettings const &getDefault();
+};
+
+
+// value in the middle of every cell, rows go by ordinate
+struct Matrix
+{
+	std::vector<float> abscissa;
+	std::vector<float> ordinate;
+	std::vector<float> values; // ordinate.size() rows of abscissa.size()
+};
+
+
 
 
 
@@ -98,6 +117,7 @@ public:
 		std::pair<value_type, value_type>
 	> chart_type;
 	typedef std::shared_ptr<chart_type> chartptr_type;
+	typedef std::shared_ptr<Matrix> matrixptr_type;
 
 
 
@@ -146,6 +166,16 @@ public:
 	ChartPrinter &clearCharts();
 
 
+	// heatmap, drawn under charts
+	ChartPrinter &setHeatmap(
+		matrixptr_type matrix,
+		HeatmapSettings const &settings =
+			HeatmapSettings::getDefault()
+	);
+	ChartPrinter &clearHeatmap();
+	bool getHeatmapValue(sf::Vector2f const &pixpoint, float &value) const;
+
+
 
 	// axis settings
 	ChartPrinter &setAxisSettings(
@@ -208,7 +238,11 @@ private:
 	void draw_axis_();
 	void draw_tags_();
 	void draw_charts_();
+	void draw_heatmap_();
+	void draw_scale_();
 
+	sf::Color scale_color_(float value) const;
+	static std::vector<float> cell_edges_(std::vector<float> const &centers);
 	static float make_beauty_(float n);
 
 
@@ -233,6 +267,11 @@ private:
 	// tags on descartes
 	Tags tags_;
 
+	// heatmap and range of its values
+	matrixptr_type heatmap_;
+	HeatmapSettings heatset_ = HeatmapSettings::getDefault();
+	float vmin_ = 0.0f, vmax_ = 0.0f;
+
 
 	// settings
 	AxisSettings axis_ = AxisSettings::getDefault();
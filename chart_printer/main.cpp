@@ -161,6 +161,34 @@ Color read_color( std::string str )
 }
 
 
+/*
+ * matrix file of test_system --grid run, floats:
+ *         columns, rows, x[columns], y[rows], value[rows][columns]
+ * nullptr if file can't be read
+ */
+std::shared_ptr<Matrix> read_matrix(std::string const &filename)
+{
+	ifstream fin(filename, ifstream::binary);
+	float size[2];
+	if(!fin.read( (char *)size, sizeof size ) || size[0] < 1 || size[1] < 1) {
+		cerr << "error: can't read matrix '" << filename << "'" << endl;
+		return nullptr;
+	}
+
+	auto matrix = std::make_shared<Matrix>();
+	matrix->abscissa.resize(size_t(size[0]));
+	matrix->ordinate.resize(size_t(size[1]));
+	matrix->values.resize(matrix->abscissa.size() * matrix->ordinate.size());
+	for(auto *v : { &matrix->abscissa, &matrix->ordinate, &matrix->values }) {
+		if(!fin.read( (char *)v->data(), v->size() * sizeof(float) )) {
+			cerr << "error: matrix '" << filename << "' is truncated" << endl;
+			return nullptr;
+		}
+	}
+	return matrix;
+}
+
+
 void init_chart(char const *filename)
 {
 	config.readFile(filename);
@@ -296,6 +324,44 @@ void init_chart(char const *filename)
 
 	}
 
+	// heatmap of matrix file, or its ratio to reference matrix
+	{
+		lookup(root, "heatmap.datafilename", sbuf, string(""));
+		auto matrix = sbuf.empty() ? nullptr : read_matrix(sbuf);
+
+		lookup(root, "heatmap.reference", sbuf, string(""));
+		if(matrix && !sbuf.empty()) {
+			auto reference = read_matrix(sbuf);
+			if(
+				reference &&
+				reference->abscissa == matrix->abscissa &&
+				reference->ordinate == matrix->ordinate
+			) {
+				for(size_t i = 0; i < matrix->values.size(); ++i)
+					matrix->values[i] /= reference->values[i];
+			}
+			else {
+				cerr << "error: reference '" << sbuf << "' has other grid" << endl;
+				matrix.reset();
+			}
+		}
+
+		if(matrix) {
+			HeatmapSettings sets = HeatmapSettings::getDefault();
+			lookup(root, "heatmap.log", sets.logscale, true);
+			lookup(root, "heatmap.scalewidth", sets.scalewidth, 40.0f);
+			try {
+				Setting const &colors = root.lookup("heatmap.colors");
+				sets.colors.clear();
+				for(int i = 0; i < colors.getLength(); ++i)
+					sets.colors.push_back(read_color(colors[i].c_str()));
+			}
+			catch(SettingNotFoundException const &e) {}
+
+			chart.setHeatmap(matrix, sets);
+		}
+	}
+
 	// aim
 	{
 		AimSettings sets;
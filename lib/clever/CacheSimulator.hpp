@@ -0,0 +1,270 @@
+#ifndef CLEVER_CACHE_SIMULATOR_HPP
+#define CLEVER_CACHE_SIMULATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace clever
+{
+
+
+
+/*
+ * Описание одного уровня: имя, полный размер в байтах,
+ * ассоциативность и размер строки. TLB описывается так же:
+ * строка - это страница, size = число записей * размер страницы.
+ */
+struct CacheLevelSettings
+{
+	std::string name;
+	size_t size;
+	size_t associativity;
+	size_t linesize;
+};
+
+
+
+/*
+ * Set-associative кэш с вытеснением LRU.
+ * Хранит только теги, данные не моделируются.
+ */
+class CacheLevel
+{
+public:
+	CacheLevel(CacheLevelSettings const &settings):
+		settings_(settings)
+	{
+		if(settings_.associativity == 0)
+			settings_.associativity = 1;
+		if(settings_.linesize == 0)
+			settings_.linesize = 64;
+
+		setcount_ = settings_.size /
+			(settings_.associativity * settings_.linesize);
+		if(setcount_ == 0)
+			setcount_ = 1;
+
+		ways_.resize(setcount_ * settings_.associativity);
+		reset();
+		return;
+	}
+
+	// true - попадание
+	bool access(uintptr_t address)
+	{
+		uintptr_t const line = address / settings_.linesize;
+		Way *b = ways_.data() + (line % setcount_) * settings_.associativity;
+		Way *e = b + settings_.associativity;
+		Way *victim = b;
+
+		++clock_;
+		for(Way *w = b; w != e; ++w) {
+			if(w->valid && w->tag == line) {
+				w->stamp = clock_;
+				++hits_;
+				return true;
+			}
+			if(!w->valid || w->stamp < victim->stamp) {
+				victim = w;
+				if(!w->valid)
+					break;
+			}
+		}
+
+		victim->valid = true;
+		victim->tag = line;
+		victim->stamp = clock_;
+		++misses_;
+		return false;
+	}
+
+	CacheLevel &reset()
+	{
+		for(auto &w : ways_)
+			w = Way();
+		clock_ = hits_ = misses_ = 0;
+		return *this;
+	}
+
+	CacheLevelSettings const &getSettings() const
+	{
+		return settings_;
+	}
+	uint64_t getHits() const
+	{
+		return hits_;
+	}
+	uint64_t getMisses() const
+	{
+		return misses_;
+	}
+
+private:
+	struct Way
+	{
+		uintptr_t tag = 0;
+		uint64_t stamp = 0;
+		bool valid = false;
+	};
+
+	CacheLevelSettings settings_;
+	size_t setcount_;
+	std::vector<Way> ways_;
+	uint64_t clock_, hits_, misses_;
+
+};
+
+
+
+/*
+ * Иерархия кэшей плюс TLB. Обращение идет в L1,
+ * при промахе - на следующий уровень и так далее.
+ * TLB проверяется на каждое обращение независимо.
+ */
+class CacheSimulator
+{
+public:
+	CacheSimulator &addLevel(CacheLevelSettings const &settings)
+	{
+		levels_.emplace_back(settings);
+		return *this;
+	}
+	CacheSimulator &setTlb(CacheLevelSettings const &settings)
+	{
+		tlb_.clear();
+		tlb_.emplace_back(settings);
+		return *this;
+	}
+
+	void access(uintptr_t address, bool /* write */ = false)
+	{
+		if(!tlb_.empty())
+			tlb_.front().access(address);
+		for(auto &level : levels_) {
+			if(level.access(address))
+				break;
+		}
+		++accesses_;
+		return;
+	}
+
+	CacheSimulator &reset()
+	{
+		for(auto &level : levels_)
+			level.reset();
+		for(auto &t : tlb_)
+			t.reset();
+		accesses_ = 0;
+		return *this;
+	}
+
+
+	std::vector<CacheLevel> const &getLevels() const
+	{
+		return levels_;
+	}
+	CacheLevel const *getTlb() const
+	{
+		return tlb_.empty() ? nullptr : &tlb_.front();
+	}
+	uint64_t getAccesses() const
+	{
+		return accesses_;
+	}
+
+
+	/*
+	 * Типичная иерархия x86-64:
+	 * L1d 32K/8, L2 256K/4, L3 8M/16, DTLB 64 записи/4 по 4K.
+	 */
+	static CacheSimulator makeDefault()
+	{
+		CacheSimulator sim;
+		sim.addLevel({ "L1", 32u << 10, 8, 64 });
+		sim.addLevel({ "L2", 256u << 10, 4, 64 });
+		sim.addLevel({ "L3", 8u << 20, 16, 64 });
+		sim.setTlb({ "TLB", 64u * 4096u, 4, 4096 });
+		return sim;
+	}
+
+	/*
+	 * Читает описание из потока, одна строка на уровень:
+	 *         name size associativity linesize
+	 * Уровень с именем TLB задает TLB. Все после '#' - комментарий.
+	 * false - строка с ошибкой (не число, ноль, лишние слова,
+	 * size меньше одного набора) или ни одного уровня; sim не меняется.
+	 */
+	static bool read(std::istream &is, CacheSimulator &sim)
+	{
+		CacheSimulator result;
+		std::string line;
+		while(std::getline(is, line)) {
+			line = line.substr(0, line.find('#'));
+
+			size_t pos = 0;
+			auto word = [&line, &pos]() {
+				size_t b = line.find_first_not_of(" \t\r", pos);
+				if(b == std::string::npos)
+					return std::string();
+				pos = line.find_first_of(" \t\r", b);
+				return line.substr(b, pos == std::string::npos ? pos : pos-b);
+			};
+			// положительное число, 0 - ошибка
+			auto number = [&word]() -> size_t {
+				std::string const w = word();
+				char *end;
+				unsigned long long const v = std::strtoull(w.c_str(), &end, 10);
+				if(w.empty() || *end != 0 || w[0] == '-')
+					return 0;
+				return v;
+			};
+
+			CacheLevelSettings sets;
+			sets.name = word();
+			if(sets.name.empty())
+				continue;
+			sets.size = number();
+			sets.associativity = number();
+			sets.linesize = number();
+			if(
+				sets.size == 0 || sets.associativity == 0 || sets.linesize == 0 ||
+				!word().empty() ||
+				sets.size / sets.associativity / sets.linesize == 0
+			) {
+				return false;
+			}
+
+			if(sets.name == "TLB")
+				result.setTlb(sets);
+			else
+				result.addLevel(sets);
+		}
+		if(result.levels_.empty() && result.tlb_.empty())
+			return false;
+
+		sim = std::move(result);
+		return true;
+	}
+
+private:
+	std::vector<CacheLevel> levels_;
+	std::vector<CacheLevel> tlb_;
+	uint64_t accesses_ = 0;
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef CLEVER_MEMORY_TRACE_HPP
+#define CLEVER_MEMORY_TRACE_HPP
+
+#include <cstdint>
+#include <utility>
+
+#include "CacheSimulator.hpp"
+
+
+namespace clever
+{
+
+
+
+/*
+ * Приемник трассы. Пока трасса не начата (sink == nullptr),
+ * Traced<T> ведет себя как обычное значение.
+ *
+ * Обращения к автоматическим переменным (временные значения
+ * в std::swap, буфер в insertion sort) в настоящем коде живут
+ * в регистрах, поэтому все, что лежит на стеке ниже точки
+ * начала трассы (в пределах stacklimit), отбрасывается.
+ */
+struct MemoryTrace
+{
+	static CacheSimulator *sink;
+	static uintptr_t stacktop;
+	constexpr static uintptr_t const stacklimit = 1u << 20;
+
+	static void begin(CacheSimulator &sim)
+	{
+		char marker;
+		stacktop = (uintptr_t)&marker;
+		sink = &sim;
+		return;
+	}
+	static void end()
+	{
+		sink = nullptr;
+		return;
+	}
+
+	static void record(void const *p, bool write)
+	{
+		if(!sink)
+			return;
+		uintptr_t const address = (uintptr_t)p;
+		if(address < stacktop && stacktop - address < stacklimit)
+			return;
+		sink->access(address, write);
+		return;
+	}
+};
+
+inline CacheSimulator *MemoryTrace::sink = nullptr;
+inline uintptr_t MemoryTrace::stacktop = 0;
+
+
+
+/*
+ * Обертка над элементом, записывающая адрес каждого
+ * чтения и записи в MemoryTrace.
+ */
+template<typename T>
+class Traced
+{
+public:
+	typedef T value_type;
+
+	Traced() = default;
+	Traced(T const &value): value_(value) {}
+
+	Traced(Traced const &other): value_(other.load())
+	{
+		MemoryTrace::record(this, true);
+		return;
+	}
+	Traced &operator=(Traced const &other)
+	{
+		T const v = other.load();
+		MemoryTrace::record(this, true);
+		value_ = v;
+		return *this;
+	}
+	Traced &operator=(T const &value)
+	{
+		MemoryTrace::record(this, true);
+		value_ = value;
+		return *this;
+	}
+
+	T load() const
+	{
+		MemoryTrace::record(this, false);
+		return value_;
+	}
+	operator T() const
+	{
+		return load();
+	}
+
+	friend bool operator<(Traced const &lhs, Traced const &rhs)
+	{
+		return lhs.load() < rhs.load();
+	}
+	friend bool operator<(Traced const &lhs, T const &rhs)
+	{
+		return lhs.load() < rhs;
+	}
+	friend bool operator<(T const &lhs, Traced const &rhs)
+	{
+		return lhs < rhs.load();
+	}
+
+private:
+	T value_;
+
+};
+
+
+
+
+}
+
+
+
+
+#endif
@@ -0,0 +1,217 @@
+#ifndef CLEVER_PROFILER_HPP
+#define CLEVER_PROFILER_HPP
+
+
+
+/*
+ * Зоны профилирования:
+ *
+ *         void foo()
+ *         {
+ *                 CLEVER_ZONE("foo");
+ *                 ...
+ *         }
+ *
+ * Без CLEVER_PROFILE макрос раскрывается в пустоту, и код
+ * профилировщика не компилируется вовсе.
+ *
+ * Зона записывается, только пока идет запись (Profiler::start()
+ * ... Profiler::stop()). Каждый поток пишет в свой кольцевой буфер
+ * без блокировок; при переполнении старые события затираются.
+ * writeChromeTrace() выводит все буферы в формате Chrome trace-event
+ * (chrome://tracing, Perfetto). Вызывать его нужно после stop(),
+ * когда зоны уже не пишутся.
+ */
+
+#ifndef CLEVER_PROFILE
+
+#define CLEVER_ZONE(name) ((void)0)
+
+#else
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <ostream>
+
+
+#define CLEVER_ZONE_CONCAT_(a, b) a##b
+#define CLEVER_ZONE_NAME_(line) CLEVER_ZONE_CONCAT_(clever_zone_, line)
+#define CLEVER_ZONE(name) \
+	::clever::ProfileZone CLEVER_ZONE_NAME_(__LINE__)(name)
+
+
+namespace clever
+{
+
+
+
+struct ProfileEvent
+{
+	char const *name;
+	int64_t begin;
+	int64_t end;
+};
+
+
+
+// кольцевой буфер одного потока: один писатель, читатель после stop()
+class ProfileBuffer
+{
+public:
+	constexpr static size_t const CAPACITY = 1u << 16;
+
+	ProfileBuffer(unsigned int tid):
+		events_(new ProfileEvent[CAPACITY]), tid_(tid) {}
+
+	void push(ProfileEvent const &e)
+	{
+		size_t const h = head_.load(std::memory_order_relaxed);
+		events_[h & (CAPACITY-1)] = e;
+		head_.store(h+1, std::memory_order_release);
+		return;
+	}
+
+	template<typename Function>
+	void forEach(Function f) const
+	{
+		size_t const h = head_.load(std::memory_order_acquire);
+		for(size_t i = h > CAPACITY ? h-CAPACITY : 0; i < h; ++i)
+			f(events_[i & (CAPACITY-1)]);
+		return;
+	}
+
+	void clear()
+	{
+		head_.store(0, std::memory_order_release);
+		return;
+	}
+
+	unsigned int getTid() const
+	{
+		return tid_;
+	}
+
+	ProfileBuffer *next = nullptr;
+
+private:
+	std::unique_ptr<ProfileEvent[]> events_;
+	std::atomic<size_t> head_{0};
+	unsigned int tid_;
+
+};
+
+
+
+class Profiler
+{
+public:
+	static void start()
+	{
+		for(auto *b = buffers_.load(std::memory_order_acquire); b; b = b->next)
+			b->clear();
+		recording_.store(true, std::memory_order_release);
+		return;
+	}
+	static void stop()
+	{
+		recording_.store(false, std::memory_order_release);
+		return;
+	}
+	static bool recording()
+	{
+		return recording_.load(std::memory_order_relaxed);
+	}
+
+	static int64_t now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - epoch_
+		).count();
+	}
+
+	// буфер текущего потока, создается при первом обращении
+	static ProfileBuffer &local()
+	{
+		thread_local ProfileBuffer *buffer = nullptr;
+		if(!buffer) {
+			// буферы живут до конца программы
+			buffer = new ProfileBuffer(tidcounter_++);
+			buffer->next = buffers_.load(std::memory_order_relaxed);
+			while(!buffers_.compare_exchange_weak(
+				buffer->next, buffer,
+				std::memory_order_release, std::memory_order_relaxed
+			));
+		}
+		return *buffer;
+	}
+
+
+	template<class Ostream>
+	static Ostream &writeChromeTrace(Ostream &os)
+	{
+		bool first = true;
+		os << "{\"traceEvents\":[\n";
+		for(auto *b = buffers_.load(std::memory_order_acquire); b; b = b->next) {
+			b->forEach([&os, &first, b](ProfileEvent const &e) {
+				if(!first)
+					os << ",\n";
+				first = false;
+				char times[64];
+				std::snprintf(
+					times, sizeof times, "\"ts\":%.3f,\"dur\":%.3f",
+					e.begin / 1000.0, (e.end - e.begin) / 1000.0
+				);
+				os << "{\"name\":\"" << e.name << "\",\"ph\":\"X\"," <<
+					times << ",\"pid\":0,\"tid\":" << b->getTid() << "}";
+			});
+		}
+		os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+		return os;
+	}
+
+private:
+	static inline std::atomic<bool> recording_{false};
+	static inline std::atomic<ProfileBuffer *> buffers_{nullptr};
+	static inline std::atomic<unsigned int> tidcounter_{0};
+	static inline std::chrono::steady_clock::time_point const epoch_ =
+		std::chrono::steady_clock::now();
+
+};
+
+
+
+class ProfileZone
+{
+public:
+	ProfileZone(char const *name):
+		name_(name), begin_(Profiler::recording() ? Profiler::now() : -1) {}
+
+	~ProfileZone()
+	{
+		if(begin_ >= 0 && Profiler::recording())
+			Profiler::local().push({ name_, begin_, Profiler::now() });
+		return;
+	}
+
+	ProfileZone(ProfileZone const &) = delete;
+	ProfileZone &operator=(ProfileZone const &) = delete;
+
+private:
+	char const *name_;
+	int64_t begin_;
+
+};
+
+
+
+
+}
+
+
+
+#endif // CLEVER_PROFILE
+
+#endif
@@ -0,0 +1,299 @@
+#ifndef CLEVER_RANDOM_HPP
+#define CLEVER_RANDOM_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace clever
+{
+
+
+
+inline uint64_t splitmix64(uint64_t &state)
+{
+	uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+inline uint64_t rotl(uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+
+
+/*
+ * xoshiro256** (Blackman, Vigna). Удовлетворяет требованиям
+ * UniformRandomBitGenerator, так что подходит для std::shuffle
+ * и распределений из <random>.
+ *
+ * Одно и то же зерно всегда дает одну и ту же последовательность.
+ * jump() сдвигает генератор на 2^128 шагов: так из одного зерна
+ * получаются независимые потоки для параллельной работы.
+ */
+class Xoshiro256
+{
+public:
+	typedef uint64_t result_type;
+
+	explicit Xoshiro256(uint64_t seed = 0)
+	{
+		this->seed(seed);
+		return;
+	}
+
+	void seed(uint64_t seed)
+	{
+		for(auto &s : s_)
+			s = splitmix64(seed);
+		return;
+	}
+
+	static constexpr result_type min()
+	{
+		return 0;
+	}
+	static constexpr result_type max()
+	{
+		return std::numeric_limits<result_type>::max();
+	}
+
+	result_type operator()()
+	{
+		uint64_t const result = rotl(s_[1] * 5, 7) * 9;
+		uint64_t const t = s_[1] << 17;
+		s_[2] ^= s_[0];
+		s_[3] ^= s_[1];
+		s_[1] ^= s_[2];
+		s_[0] ^= s_[3];
+		s_[2] ^= t;
+		s_[3] = rotl(s_[3], 45);
+		return result;
+	}
+
+	// равномерно в [0, range), без деления (Lemire)
+	uint64_t bounded(uint64_t range)
+	{
+		__uint128_t m = (__uint128_t)(*this)() * range;
+		uint64_t l = (uint64_t)m;
+		if(l < range) {
+			uint64_t const t = -range % range;
+			while(l < t) {
+				m = (__uint128_t)(*this)() * range;
+				l = (uint64_t)m;
+			}
+		}
+		return m >> 64;
+	}
+
+	Xoshiro256 &jump()
+	{
+		static uint64_t const JUMP[] = {
+			0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull,
+			0xa9582618e03fc9aaull, 0x39abdc4529b1661cull
+		};
+
+		uint64_t s[4] = {0, 0, 0, 0};
+		for(uint64_t j : JUMP) {
+			for(int b = 0; b < 64; ++b) {
+				if(j & (1ull << b))
+					for(int i = 0; i < 4; ++i)
+						s[i] ^= s_[i];
+				(*this)();
+			}
+		}
+		std::copy(s, s+4, s_);
+		return *this;
+	}
+
+	// независимый поток: копия, сдвинутая на (index+1) прыжков
+	Xoshiro256 stream(unsigned int index) const
+	{
+		Xoshiro256 r(*this);
+		for(unsigned int i = 0; i <= index; ++i)
+			r.jump();
+		return r;
+	}
+
+private:
+	uint64_t s_[4];
+
+};
+
+
+
+/*
+ * Четыре генератора xoshiro256** с разными зернами, шагающие
+ * одновременно. Состояние хранится по полосам, умножения на 5 и 9
+ * заменены сдвигами, поэтому fill() векторизуется компилятором
+ * (SSE2/AVX2) и выдает блок значений за несколько тактов на четверку.
+ */
+class Xoshiro256x4
+{
+public:
+	explicit Xoshiro256x4(uint64_t seed = 0)
+	{
+		for(int lane = 0; lane < 4; ++lane)
+			for(int i = 0; i < 4; ++i)
+				s_[i][lane] = splitmix64(seed);
+		return;
+	}
+
+	// n значений в out, n кратно 4 не обязательно
+	void fill(uint64_t *out, size_t n)
+	{
+		size_t i = 0;
+		for(; i + 4 <= n; i += 4)
+			step_(out + i);
+
+		if(i < n) {
+			uint64_t tail[4];
+			step_(tail);
+			std::copy(tail, tail + (n - i), out + i);
+		}
+		return;
+	}
+
+private:
+	void step_(uint64_t *out)
+	{
+		for(int l = 0; l < 4; ++l) {
+			uint64_t const x5 = (s_[1][l] << 2) + s_[1][l];
+			uint64_t const r = (x5 << 7) | (x5 >> 57);
+			out[l] = (r << 3) + r;
+		}
+		for(int l = 0; l < 4; ++l) {
+			uint64_t const t = s_[1][l] << 17;
+			s_[2][l] ^= s_[0][l];
+			s_[3][l] ^= s_[1][l];
+			s_[1][l] ^= s_[2][l];
+			s_[0][l] ^= s_[3][l];
+			s_[2][l] ^= t;
+			s_[3][l] = (s_[3][l] << 45) | (s_[3][l] >> 19);
+		}
+		return;
+	}
+
+	alignas(32) uint64_t s_[4][4];
+
+};
+
+
+
+// Fisher-Yates с bounded() вместо std::uniform_int_distribution
+template<typename Iter>
+void shuffle(Iter b, Iter e, Xoshiro256 &rng)
+{
+	using std::swap;
+	for(auto n = e - b; n > 1; --n)
+		swap(b[n-1], b[rng.bounded(n)]);
+	return;
+}
+
+
+
+/*
+ * Параллельное перемешивание (Sanders, 1998): каждый элемент
+ * уходит в случайную корзину, корзины перемешиваются независимо.
+ * Результат - равномерная случайная перестановка, зависящая только
+ * от зерна: массив делится на PARTS частей с собственными потоками
+ * генератора, и потоки исполнения лишь разбирают части и корзины.
+ * Корзины порядка 64K элементов, так что и в одном потоке
+ * перемешивание идет в кэше, а не по всей памяти.
+ * Нужен буфер на n элементов.
+ */
+template<typename T>
+void parallel_shuffle(T *d, size_t n, uint64_t seed, unsigned int threads = 0)
+{
+	constexpr size_t const PARTS = 64;
+
+	Xoshiro256 seeder(seed);
+	if(n < (1u << 16)) {
+		shuffle(d, d+n, seeder);
+		return;
+	}
+	if(threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+
+	size_t const buckets = n >> 16;
+	std::vector<T> tmp(n);
+	std::vector<uint32_t> target(n);
+	std::vector<size_t> offset(PARTS * buckets, 0);
+	std::vector<uint64_t> partseed(PARTS), bucketseed(buckets);
+	for(auto &s : partseed)
+		s = seeder();
+	for(auto &s : bucketseed)
+		s = seeder();
+
+	auto run = [threads](size_t count, auto f) {
+		auto work = [&](unsigned int t) {
+			for(size_t i = t; i < count; i += threads)
+				f(i);
+		};
+		std::vector<std::thread> pool;
+		for(unsigned int t = 1; t < threads; ++t)
+			pool.emplace_back(work, t);
+		work(0);
+		for(auto &t : pool)
+			t.join();
+	};
+
+
+	// random bucket of every element, histogram per part
+	run(PARTS, [&](size_t p) {
+		Xoshiro256 rng(partseed[p]);
+		size_t *count = offset.data() + p * buckets;
+		for(size_t i = n*p/PARTS, e = n*(p+1)/PARTS; i < e; ++i) {
+			target[i] = rng.bounded(buckets);
+			++count[target[i]];
+		}
+	});
+
+	// start of every (bucket, part) piece
+	size_t sum = 0;
+	std::vector<size_t> bucketbegin(buckets + 1);
+	for(size_t b = 0; b < buckets; ++b) {
+		bucketbegin[b] = sum;
+		for(size_t p = 0; p < PARTS; ++p) {
+			size_t const c = offset[p * buckets + b];
+			offset[p * buckets + b] = sum;
+			sum += c;
+		}
+	}
+	bucketbegin[buckets] = n;
+
+	// scatter, then shuffle every bucket and move it back
+	run(PARTS, [&](size_t p) {
+		size_t *pos = offset.data() + p * buckets;
+		for(size_t i = n*p/PARTS, e = n*(p+1)/PARTS; i < e; ++i)
+			tmp[pos[target[i]]++] = std::move(d[i]);
+	});
+	run(buckets, [&](size_t b) {
+		Xoshiro256 rng(bucketseed[b]);
+		shuffle(tmp.begin() + bucketbegin[b], tmp.begin() + bucketbegin[b+1], rng);
+		std::move(
+			tmp.begin() + bucketbegin[b], tmp.begin() + bucketbegin[b+1],
+			d + bucketbegin[b]
+		);
+	});
+
+	return;
+}
+
+
+
+
+}
+
+
+
+
+#endif
@@ -0,0 +1,222 @@
+#ifndef CLEVER_TASK_POOL_HPP
+#define CLEVER_TASK_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace clever
+{
+
+
+
+/*
+ * Группа задач: wait() ждет, пока не выполнятся все задачи,
+ * запущенные в группе через TaskPool::spawn().
+ */
+class TaskGroup
+{
+public:
+	TaskGroup() = default;
+	TaskGroup(TaskGroup const &) = delete;
+	TaskGroup &operator=(TaskGroup const &) = delete;
+
+private:
+	friend class TaskPool;
+	std::atomic<size_t> pending_{0};
+
+};
+
+
+
+/*
+ * Пул потоков с кражей работы (fork-join):
+ *
+ *         clever::TaskGroup group;
+ *         pool.spawn(group, [&]{ left(); });
+ *         right();
+ *         pool.wait(group);
+ *
+ * У каждого потока своя очередь: новые задачи кладутся в ее конец
+ * и берутся оттуда же (LIFO, горячие данные в кэше), свободный
+ * поток крадет самую старую (крупную) задачу из начала чужой
+ * очереди. wait() не блокирует поток, а выполняет задачи, пока
+ * группа не опустеет, поэтому вложенные spawn/wait не
+ * взаимоблокируются. Потоки, не принадлежащие пулу, кладут
+ * задачи в очередь 0. Простаивающий поток недолго крутится,
+ * а затем засыпает до новой задачи.
+ */
+class TaskPool
+{
+public:
+	// threads - число потоков вместе с вызывающим, 0 - по числу ядер
+	explicit TaskPool(unsigned int threads = 0)
+	{
+		if(threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		for(unsigned int i = 0; i < threads; ++i)
+			queues_.emplace_back(new Queue_);
+		for(unsigned int i = 1; i < threads; ++i)
+			workers_.emplace_back(&TaskPool::work_, this, i);
+		return;
+	}
+
+	~TaskPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleepmutex_);
+			stop_.store(true, std::memory_order_release);
+		}
+		wakeup_.notify_all();
+		for(auto &w : workers_)
+			w.join();
+		return;
+	}
+
+	TaskPool(TaskPool const &) = delete;
+	TaskPool &operator=(TaskPool const &) = delete;
+
+
+
+	unsigned int size() const
+	{
+		return queues_.size();
+	}
+
+	template<typename Function>
+	void spawn(TaskGroup &group, Function &&f)
+	{
+		group.pending_.fetch_add(1, std::memory_order_relaxed);
+		{
+			Queue_ &q = *queues_[self_()];
+			std::lock_guard<std::mutex> lock(q.mutex);
+			q.tasks.push_back({ std::function<void()>(std::forward<Function>(f)), &group });
+		}
+		{
+			std::lock_guard<std::mutex> lock(sleepmutex_);
+			queued_.fetch_add(1, std::memory_order_release);
+		}
+		wakeup_.notify_one();
+		return;
+	}
+
+	void wait(TaskGroup &group)
+	{
+		unsigned int const self = self_();
+		while(group.pending_.load(std::memory_order_acquire) != 0)
+			if(!run_one_(self))
+				std::this_thread::yield();
+		return;
+	}
+
+private:
+	struct Task_
+	{
+		std::function<void()> f;
+		TaskGroup *group;
+	};
+
+	struct Queue_
+	{
+		std::mutex mutex;
+		std::deque<Task_> tasks;
+	};
+
+
+
+	// номер очереди текущего потока
+	unsigned int self_() const
+	{
+		return current_.pool == this ? current_.index : 0;
+	}
+
+	// своя задача с конца или чужая с начала, false если нет задач
+	bool run_one_(unsigned int self)
+	{
+		Task_ task;
+		bool found = false;
+		for(unsigned int k = 0; k < queues_.size() && !found; ++k) {
+			unsigned int const i = (self + k) % queues_.size();
+			Queue_ &q = *queues_[i];
+			std::lock_guard<std::mutex> lock(q.mutex);
+			if(q.tasks.empty())
+				continue;
+			if(k == 0) {
+				task = std::move(q.tasks.back());
+				q.tasks.pop_back();
+			}
+			else {
+				task = std::move(q.tasks.front());
+				q.tasks.pop_front();
+			}
+			found = true;
+		}
+		if(!found)
+			return false;
+
+		queued_.fetch_sub(1, std::memory_order_relaxed);
+		task.f();
+		task.group->pending_.fetch_sub(1, std::memory_order_release);
+		return true;
+	}
+
+	void work_(unsigned int index)
+	{
+		constexpr static unsigned int const SPINS = 1024;
+
+		current_ = { this, index };
+		for(unsigned int idle = 0; !stop_.load(std::memory_order_acquire); ) {
+			if(run_one_(index)) {
+				idle = 0;
+			}
+			else if(++idle < SPINS) {
+				std::this_thread::yield();
+			}
+			else {
+				std::unique_lock<std::mutex> lock(sleepmutex_);
+				wakeup_.wait(lock, [this] {
+					return
+						queued_.load(std::memory_order_acquire) != 0 ||
+						stop_.load(std::memory_order_acquire);
+				});
+				idle = 0;
+			}
+		}
+		return;
+	}
+
+
+
+	struct Current_
+	{
+		TaskPool const *pool;
+		unsigned int index;
+	};
+	static inline thread_local Current_ current_{ nullptr, 0 };
+
+	std::vector<std::unique_ptr<Queue_>> queues_;
+	std::vector<std::thread> workers_;
+	std::atomic<bool> stop_{false};
+
+	// число задач в очередях, для сна простаивающих потоков
+	std::atomic<size_t> queued_{0};
+	std::mutex sleepmutex_;
+	std::condition_variable wakeup_;
+
+};
+
+
+
+
+}
+
+
+
+#endif
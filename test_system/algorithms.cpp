@@ -0,0 +1,173 @@
+#ifndef ALGORITHMS_CPP
+#define ALGORITHMS_CPP
+
+#include <string>
+#include <vector>
+
+#include "sort/block_merge_sort.cpp"
+#include "sort/bubble_sort.cpp"
+#include "sort/indirect_sort.cpp"
+#include "sort/insertion_sort.cpp"
+#include "sort/list_insertion_sort.cpp"
+#include "sort/list_merge_sort.cpp"
+#include "sort/merge_kernel.cpp"
+#include "sort/merge_sort.cpp"
+#include "sort/network_sort.cpp"
+#include "sort/parallel_merge_sort.cpp"
+#include "sort/pdq_sort.cpp"
+#include "sort/pingpong_merge_sort.cpp"
+#include "sort/power_sort.cpp"
+#include "sort/radix_sort.cpp"
+#include "sort/sample_sort.cpp"
+#include "sort/select.cpp"
+#include "sort/selection_sort.cpp"
+#include "sort/std_sort.cpp"
+#include "sort/string_sort.cpp"
+#include "sort/top_k.cpp"
+
+
+
+
+
+/*
+ * All algorithms of the test system in one list,
+ * for tools working with every algorithm at once (check --fuzz).
+ * Array is any struct with value_type, d and n (RandomArrayStruct).
+ *
+ * List sorts are run on a list built from the array.
+ *
+ * Selection and top-k algorithms sort only a part: sort is the run
+ * with k of selection_settings(), select takes k (null for sorts).
+ * topk: k smallest elements are sorted at the start, otherwise only
+ * the k-th is in place. See select.cpp and top_k.cpp.
+ *
+ * New algorithm: add it here, to main.cpp and to testing.sh.
+ */
+template<typename Array>
+struct Algorithm
+{
+	char const *name;
+	void(*sort)(Array &);
+	bool stable;
+
+	void(*select)(Array &, size_t);
+	bool topk;
+};
+
+
+
+// list sort on array: nodes are linked in array order,
+// sorted values are copied back
+template<
+	typename Array,
+	void(*Sort)(ListStruct<typename Array::value_type> &)
+>
+void list_sort_on_array(Array &ar)
+{
+	typedef ListStruct<typename Array::value_type> list_struct;
+	std::vector<typename list_struct::node_type> nodes(ar.n);
+	for(unsigned int i = 0; i < ar.n; ++i)
+		nodes[i] = { ar.d[i], i+1 < ar.n ? &nodes[i+1] : nullptr };
+
+	list_struct list;
+	list.head = ar.n ? nodes.data() : nullptr;
+	list.n = ar.n;
+	Sort(list);
+
+	unsigned int i = 0;
+	for(auto *node = list.head; node; node = node->next)
+		ar.d[i++] = node->value;
+	return;
+}
+
+
+
+template<typename Array>
+std::vector<Algorithm<Array>> const &algorithms()
+{
+	static std::vector<Algorithm<Array>> const list {
+		{ "bubble_sort", &bubble_sort<Array>, true },
+		{ "selection_sort", &selection_sort<Array>, false },
+		{ "insertion_sort", &insertion_sort<Array>, true },
+		{ "merge_sort", &merge_sort<Array>, true },
+		{ "pingpong_merge_sort", &pingpong_merge_sort<Array>, true },
+		{ "kernel_merge_sort", &kernel_merge_sort<Array>, true },
+		{ "network_sort", &network_sort<Array>, true },
+		{ "network_merge_sort", &network_merge_sort<Array>, true },
+		{ "radix_sort", &radix_sort<Array>, true },
+		{ "radix11_sort", &radix11_sort<Array>, true },
+		{ "pdq_sort", &pdq_sort<Array>, false },
+		{ "std_sort", &std_sort<Array>, false },
+		{ "std_stable_sort", &std_stable_sort<Array>, true },
+		{ "grail_sort", &grail_sort<Array>, true },
+		{ "grail_cache_sort", &grail_cache_sort<Array>, true },
+		{ "power_sort", &power_sort<Array>, true },
+		{ "insertion_sort_function_compare", &insertion_sort_function_compare<Array>, true },
+		{ "merge_sort_function_compare", &merge_sort_function_compare<Array>, true },
+		{ "pdq_sort_function_compare", &pdq_sort_function_compare<Array>, false },
+		{ "power_sort_function_compare", &power_sort_function_compare<Array>, true },
+		{ "grail_sort_function_compare", &grail_sort_function_compare<Array>, true },
+		{ "indirect_pdq_sort", &indirect_pdq_sort<Array>, true },
+		{ "indirect_pdq_cycle_sort", &indirect_pdq_cycle_sort<Array>, true },
+		{ "indirect_radix_sort", &indirect_radix_sort<Array>, true },
+		{ "indirect_radix_cycle_sort", &indirect_radix_cycle_sort<Array>, true },
+		{ "parallel_merge_sort", &parallel_merge_sort<Array>, true },
+		{ "sample_sort", &sample_sort<Array>, false },
+		{ "quick_select", &quick_select<Array>, false, &quick_select<Array>, false },
+		{ "intro_select", &intro_select<Array>, false, &intro_select<Array>, false },
+		{ "floyd_rivest_select", &floyd_rivest_select<Array>, false, &floyd_rivest_select<Array>, false },
+		{ "median_of_medians_select", &median_of_medians_select<Array>, false, &median_of_medians_select<Array>, false },
+		{ "std_nth_element", &std_nth_element<Array>, false, &std_nth_element<Array>, false },
+		{ "heap_top_k", &heap_top_k<Array>, false, &heap_top_k<Array>, true },
+		{ "partial_quick_sort", &partial_quick_sort<Array>, false, &partial_quick_sort<Array>, true },
+		{ "std_partial_sort", &std_partial_sort<Array>, false, &std_partial_sort<Array>, true },
+		{ "sort_top_k", &sort_top_k<Array>, false, &sort_top_k<Array>, true },
+		{
+			"list_insertion_sort",
+			&list_sort_on_array<
+				Array, &list_insertion_sort<ListStruct<typename Array::value_type>>
+			>,
+			true
+		},
+		{
+			"list_merge_sort",
+			&list_sort_on_array<
+				Array, &list_merge_sort<ListStruct<typename Array::value_type>>
+			>,
+			true
+		},
+	};
+	return list;
+}
+
+/*
+ * String sorts, Array of CString (string_array.cpp).
+ * Any algorithm above sorts strings too, by comparisons.
+ */
+template<typename Array>
+std::vector<Algorithm<Array>> const &string_algorithms()
+{
+	static std::vector<Algorithm<Array>> const list {
+		{ "msd_radix_sort", &msd_radix_sort<Array>, true },
+		{ "multikey_quick_sort", &multikey_quick_sort<Array>, false },
+		{ "lcp_merge_sort", &lcp_merge_sort<Array>, true },
+	};
+	return list;
+}
+
+
+
+template<typename Array>
+Algorithm<Array> const *find_algorithm(std::string const &name)
+{
+	for(auto const &a : algorithms<Array>())
+		if(name == a.name)
+			return &a;
+	return nullptr;
+}
+
+
+
+
+
+#endif
@@ -0,0 +1,102 @@
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <clever/CacheSimulator.hpp>
+#include <clever/MemoryTrace.hpp>
+
+#include "structures/traced_array.cpp"
+
+
+
+
+
+/*
+ * Cache trace mode (-DCACHE_TRACE).
+ *
+ * After every measured N the algorithm is executed once more
+ * on a traced copy of the input. Every load and store goes to
+ * the cache simulator, and simulated misses of each level are
+ * written to "<output>.<level>.chart" next to the time chart.
+ * Tracing runs outside the stopwatch, so timings are not affected.
+ */
+class CacheTrace
+{
+public:
+	void open(
+		std::string const &outfilename,
+		clever::CacheSimulator const &sim
+	)
+	{
+		sim_ = sim;
+		files_.clear();
+
+		for(auto const &level : sim_.getLevels())
+			open_file_(outfilename, level.getSettings().name);
+		if(sim_.getTlb())
+			open_file_(outfilename, sim_.getTlb()->getSettings().name);
+		return;
+	}
+
+	bool good() const
+	{
+		for(auto const &f : files_)
+			if(!*f)
+				return false;
+		return true;
+	}
+
+
+	template<typename DataType, typename Algorithm>
+	void measure(DataType const &data, Algorithm alg)
+	{
+		TracedArrayStruct<typename DataType::value_type> array;
+		array.assign(data.d, data.n);
+
+		sim_.reset();
+		clever::MemoryTrace::begin(sim_);
+		alg(array);
+		clever::MemoryTrace::end();
+
+		float const x = (float)data.getN();
+		size_t i = 0;
+		for(auto const &level : sim_.getLevels())
+			write_point_(*files_[i++], x, (float)level.getMisses());
+		if(sim_.getTlb())
+			write_point_(*files_[i++], x, (float)sim_.getTlb()->getMisses());
+		return;
+	}
+
+private:
+	void open_file_(std::string const &outfilename, std::string const &name)
+	{
+		files_.emplace_back(new std::ofstream(
+			outfilename + "." + name + ".chart",
+			std::ofstream::binary
+		));
+		return;
+	}
+
+	static void write_point_(std::ostream &os, float x, float y)
+	{
+		os.write( (char const *)&x, sizeof x );
+		os.write( (char const *)&y, sizeof y );
+		return;
+	}
+
+
+
+	clever::CacheSimulator sim_;
+	std::vector<std::unique_ptr<std::ofstream>> files_;
+
+};
+
+
+CacheTrace cache_trace;
+
+
+
+
+
+// end
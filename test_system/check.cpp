@@ -1,34 +1,143 @@
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <iostream>
+#include <mutex>
 #include <random>
+#include <thread>
+#include <type_traits>
+
+#include <unistd.h>
 
 #include <clever/IostreamFunction.hpp>
 
+#include "algorithms.cpp"
+#include "options.cpp"
+#include "structures/distribution.cpp"
+
 
 
 #ifdef SELECTION_SORT
-	#include "sort/selection_sort.cpp"
-	typedef random_array_type data_type;
-	constexpr void(*algorithm)(data_type &) = &selection_sort;
+	char const *DEFAULT_ALGORITHM = "selection_sort";
 
 #elif INSERTION_SORT
-	#include "sort/insertion_sort.cpp"
-	typedef random_array_type data_type;
-	constexpr void(*algorithm)(data_type &) = &insertion_sort; 
+	char const *DEFAULT_ALGORITHM = "insertion_sort";
 
 #elif BUBBLE_SORT
-	#include "sort/bubble_sort.cpp"
-	typedef random_array_type data_type;
-	constexpr void(*algorithm)(data_type &) = &bubble_sort;
+	char const *DEFAULT_ALGORITHM = "bubble_sort";
 
 #elif MERGE_SORT
-	#include "sort/merge_sort.cpp"
-	typedef random_array_type data_type;
-	constexpr void(*algorithm)(data_type &) = &merge_sort;
+	char const *DEFAULT_ALGORITHM = "merge_sort";
+
+#elif PINGPONG_MERGE_SORT
+	char const *DEFAULT_ALGORITHM = "pingpong_merge_sort";
+
+#elif KERNEL_MERGE_SORT
+	char const *DEFAULT_ALGORITHM = "kernel_merge_sort";
+
+#elif NETWORK_SORT
+	char const *DEFAULT_ALGORITHM = "network_sort";
+
+#elif NETWORK_MERGE_SORT
+	char const *DEFAULT_ALGORITHM = "network_merge_sort";
+
+#elif RADIX_SORT
+	char const *DEFAULT_ALGORITHM = "radix_sort";
+
+#elif RADIX11_SORT
+	char const *DEFAULT_ALGORITHM = "radix11_sort";
+
+#elif PDQ_SORT
+	char const *DEFAULT_ALGORITHM = "pdq_sort";
+
+#elif STD_SORT
+	char const *DEFAULT_ALGORITHM = "std_sort";
+
+#elif STD_STABLE_SORT
+	char const *DEFAULT_ALGORITHM = "std_stable_sort";
+
+#elif GRAIL_SORT
+	char const *DEFAULT_ALGORITHM = "grail_sort";
+
+#elif GRAIL_CACHE_SORT
+	char const *DEFAULT_ALGORITHM = "grail_cache_sort";
+
+#elif POWER_SORT
+	char const *DEFAULT_ALGORITHM = "power_sort";
+
+#elif INSERTION_SORT_FUNCTION_COMPARE
+	char const *DEFAULT_ALGORITHM = "insertion_sort_function_compare";
+
+#elif MERGE_SORT_FUNCTION_COMPARE
+	char const *DEFAULT_ALGORITHM = "merge_sort_function_compare";
+
+#elif PDQ_SORT_FUNCTION_COMPARE
+	char const *DEFAULT_ALGORITHM = "pdq_sort_function_compare";
+
+#elif POWER_SORT_FUNCTION_COMPARE
+	char const *DEFAULT_ALGORITHM = "power_sort_function_compare";
+
+#elif GRAIL_SORT_FUNCTION_COMPARE
+	char const *DEFAULT_ALGORITHM = "grail_sort_function_compare";
+
+#elif QUICK_SELECT
+	char const *DEFAULT_ALGORITHM = "quick_select";
+
+#elif INTRO_SELECT
+	char const *DEFAULT_ALGORITHM = "intro_select";
+
+#elif FLOYD_RIVEST_SELECT
+	char const *DEFAULT_ALGORITHM = "floyd_rivest_select";
+
+#elif MEDIAN_OF_MEDIANS_SELECT
+	char const *DEFAULT_ALGORITHM = "median_of_medians_select";
+
+#elif STD_NTH_ELEMENT
+	char const *DEFAULT_ALGORITHM = "std_nth_element";
+
+#elif HEAP_TOP_K
+	char const *DEFAULT_ALGORITHM = "heap_top_k";
+
+#elif PARTIAL_QUICK_SORT
+	char const *DEFAULT_ALGORITHM = "partial_quick_sort";
+
+#elif STD_PARTIAL_SORT
+	char const *DEFAULT_ALGORITHM = "std_partial_sort";
+
+#elif SORT_TOP_K
+	char const *DEFAULT_ALGORITHM = "sort_top_k";
+
+#elif INDIRECT_PDQ_SORT
+	char const *DEFAULT_ALGORITHM = "indirect_pdq_sort";
+
+#elif INDIRECT_PDQ_CYCLE_SORT
+	char const *DEFAULT_ALGORITHM = "indirect_pdq_cycle_sort";
+
+#elif INDIRECT_RADIX_SORT
+	char const *DEFAULT_ALGORITHM = "indirect_radix_sort";
+
+#elif INDIRECT_RADIX_CYCLE_SORT
+	char const *DEFAULT_ALGORITHM = "indirect_radix_cycle_sort";
+
+#elif PARALLEL_MERGE_SORT
+	char const *DEFAULT_ALGORITHM = "parallel_merge_sort";
+
+#elif SAMPLE_SORT
+	char const *DEFAULT_ALGORITHM = "sample_sort";
+
+#elif LIST_INSERTION_SORT
+	char const *DEFAULT_ALGORITHM = "list_insertion_sort";
+
+#elif LIST_MERGE_SORT
+	char const *DEFAULT_ALGORITHM = "list_merge_sort";
 
 #else
-	static_assert(false);
+	char const *DEFAULT_ALGORITHM = "";
 
 #endif
 
@@ -40,10 +149,745 @@ using namespace std;
 
 
 
-int main( int argc, char *argv[] )
+/*
+ * check [--algorithm=name]
+ *         sorts shuffled 0..19 and prints vector before and after.
+ *
+ * check --fuzz [--algorithm=name] [--iterations=1000] [--maxsize=2000]
+ *         [--seed=S] [--threads=T] [--cutoff=16] [--samplebase=256]
+ *         differential fuzzing: every algorithm (or only the given one)
+ *         runs on random sizes and distributions, the result is compared
+ *         with std::stable_sort. Stable algorithms are also checked
+ *         for stability by tagged elements. Selection and top-k ones
+ *         get random k and only their part is checked. The first failing
+ *         input is shrunk to a minimal one and printed. Parallel sorts get
+ *         a small sequential cutoff and at least 4 pool threads, so that
+ *         small inputs are split into tasks; sample_sort gets a small
+ *         base, so they go through its partition. Sorts run again on int32, int64, float and double keys
+ *         with extremes (infinities, -0.0), the types of the fast paths
+ *         for <, and are compared bit for bit. String sorts run after
+ *         them on random strings, then key dumps (main --dump) are
+ *         written and read back by replay: and sample: distributions.
+ */
+
+
+
+
+
+// element with original position, compared by key only
+struct Tagged
+{
+	int key;
+	unsigned int tag;
+};
+
+inline bool operator<(Tagged const &lhs, Tagged const &rhs)
+{
+	return lhs.key < rhs.key;
+}
+
+struct TaggedArrayStruct
+{
+	typedef Tagged value_type;
+
+	Tagged *d;
+	unsigned int n;
+};
+
+typedef Algorithm<TaggedArrayStruct> tagged_algorithm_type;
+
+
+
+// generic sorts (sort/compare.cpp) at compile time, by < and by
+// projection; enough elements for pdq partitions and the ninther
+constexpr size_t const CONSTEXPR_CHECK_SIZE = 200u;
+
+struct Negate
+{
+	constexpr int operator()(int v) const
+	{
+		return -v;
+	}
+};
+
+template<typename Projection, typename Sort>
+constexpr bool sorts_at_compile_time(Sort sort)
+{
+	int a[CONSTEXPR_CHECK_SIZE] = {};
+	for(size_t i = 0; i < CONSTEXPR_CHECK_SIZE; ++i)
+		a[i] = int(i * 37 % 101);
+	sort(a, a + CONSTEXPR_CHECK_SIZE, Less(), Projection());
+	for(size_t i = 1; i < CONSTEXPR_CHECK_SIZE; ++i)
+		if(Projection()(a[i]) < Projection()(a[i-1]))
+			return false;
+	return true;
+}
+
+template<typename Projection>
+constexpr bool generic_sorts_at_compile_time()
+{
+	return
+		sorts_at_compile_time<Projection>(
+			[](int *b, int *e, Less c, Projection p) { bubble_sort(b, e, c, p); }
+		) &&
+		sorts_at_compile_time<Projection>(
+			[](int *b, int *e, Less c, Projection p) { selection_sort(b, e, c, p); }
+		) &&
+		sorts_at_compile_time<Projection>(
+			[](int *b, int *e, Less c, Projection p) { insertion_sort(b, e, c, p); }
+		) &&
+		sorts_at_compile_time<Projection>(
+			[](int *b, int *e, Less c, Projection p) { pdq_sort(b, e, c, p); }
+		) &&
+		sorts_at_compile_time<Projection>(
+			[](int *b, int *e, Less c, Projection p) {
+				int buf[CONSTEXPR_CHECK_SIZE] = {};
+				merge_sort_buffered(b, e, buf, make_compare(c, p));
+			}
+		);
+}
+
+static_assert(generic_sorts_at_compile_time<Identity>(), "generic sorts by < aren't constexpr");
+static_assert(generic_sorts_at_compile_time<Negate>(), "generic sorts by projection aren't constexpr");
+
+
+
+// true if algorithm sorts keys wrong; selection algorithms
+// get rank k, clamped to the size
+bool fails(tagged_algorithm_type const &alg, std::vector<int> const &keys, size_t k)
+{
+	std::vector<Tagged> data(keys.size()), expected;
+	for(size_t i = 0; i < keys.size(); ++i)
+		data[i] = { keys[i], (unsigned int)i };
+
+	expected = data;
+	std::stable_sort(expected.begin(), expected.end());
+
+	TaggedArrayStruct ar { data.data(), (unsigned int)data.size() };
+	if(!alg.select) {
+		alg.sort(ar);
+	}
+	else if(!data.empty()) {
+		k = std::min(k, alg.topk ? data.size() : data.size()-1);
+		alg.select(ar, k);
+
+		// k smallest sorted, or k-th in place and the others around it
+		for(size_t i = 0; i < data.size(); ++i) {
+			if(alg.topk ? i < k && data[i].key != expected[i].key :
+				(i < k && data[k] < data[i]) ||
+				(i == k && data[i].key != expected[i].key) ||
+				(i > k && data[i] < data[k])
+			)
+				return true;
+		}
+	}
+
+	// unstable algorithm: any order of equal keys,
+	// but it still must be a permutation
+	if(!alg.stable) {
+		if(!alg.select)
+			for(size_t i = 0; i < data.size(); ++i)
+				if(data[i].key != expected[i].key)
+					return true;
+		auto bykeytag = [](Tagged const &l, Tagged const &r) {
+			return l.key < r.key || (l.key == r.key && l.tag < r.tag);
+		};
+		std::sort(data.begin(), data.end(), bykeytag);
+	}
+
+	for(size_t i = 0; i < data.size(); ++i)
+		if(data[i].key != expected[i].key || data[i].tag != expected[i].tag)
+			return true;
+	return false;
+}
+
+
+
+// input of fuzzing case
+std::vector<int> generate(std::mt19937_64 &rng, size_t maxsize)
+{
+	// small sizes are the most interesting
+	size_t n;
+	switch(rng() % 4) {
+	case 0:
+		n = rng() % 4;
+		break;
+	case 1:
+		n = rng() % 64;
+		break;
+	default:
+		n = std::min<size_t>(
+			maxsize, std::exp2(std::uniform_real_distribution<double>(
+				0.0, std::log2(maxsize + 1.0)
+			)(rng))
+		);
+		break;
+	}
+
+	std::vector<int> keys(n);
+	std::uniform_int_distribution<int> wide(INT_MIN, INT_MAX);
+	int const narrow = 1 + rng() % 8;
+	std::uniform_int_distribution<int> dups(-narrow, narrow);
+
+	switch(rng() % 8) {
+	case 0: // full range, negative values and extremes
+		for(auto &k : keys)
+			k = rng() % 16 == 0 ? (rng() % 2 ? INT_MIN : INT_MAX) : wide(rng);
+		break;
+	case 1: // all equal
+		std::fill(keys.begin(), keys.end(), dups(rng));
+		break;
+	case 2: // sorted
+		for(auto &k : keys)
+			k = dups(rng);
+		std::sort(keys.begin(), keys.end());
+		break;
+	case 3: // reversed
+		for(auto &k : keys)
+			k = wide(rng);
+		std::sort(keys.rbegin(), keys.rend());
+		break;
+	case 4: // sorted with few swaps
+		for(size_t i = 0; i < n; ++i)
+			keys[i] = int(i) - int(n/2);
+		for(size_t i = 0; n > 1 && i < 1 + n/16; ++i)
+			std::swap(keys[rng() % n], keys[rng() % n]);
+		break;
+	case 5: // input shapes of the harness, shifted to negative values
+	{
+		static char const *const SHAPES[] = {
+			"sorted", "reversed", "nearly_sorted:3", "runs:4",
+			"sawtooth:5", "organ_pipe", "duplicates:3", "zipf:1.2"
+		};
+		Distribution dist;
+		dist.parse(SHAPES[rng() % (sizeof SHAPES / sizeof *SHAPES)]);
+		dist.fill(keys.data(), n, rng);
+		for(auto &k : keys)
+			k -= int(n/2);
+		break;
+	}
+	default: // many duplicates
+		for(auto &k : keys)
+			k = dups(rng);
+		break;
+	}
+
+	return keys;
+}
+
+
+
+// remove chunks and simplify values while input still fails
+std::vector<int> shrink(
+	tagged_algorithm_type const &alg, std::vector<int> keys, size_t k
+)
+{
+	for(size_t chunk = std::max<size_t>(keys.size()/2, 1); ; ) {
+		bool removed = false;
+		for(size_t i = 0; i < keys.size(); ) {
+			std::vector<int> trial(keys);
+			trial.erase(
+				trial.begin()+i,
+				trial.begin()+std::min(i+chunk, trial.size())
+			);
+			if(fails(alg, trial, k)) {
+				keys.swap(trial);
+				removed = true;
+			}
+			else {
+				i += chunk;
+			}
+		}
+		if(chunk == 1 && !removed)
+			break;
+		if(chunk > 1)
+			chunk /= 2;
+	}
+
+	for(auto &key : keys) {
+		while(key != 0) {
+			int const old = key;
+			key = old/2;
+			if(!fails(alg, keys, k)) {
+				key = old;
+				break;
+			}
+		}
+	}
+
+	return keys;
+}
+
+
+
+// plain arithmetic keys: only they take the fast paths for <
+// (AVX2 merge kernel and networks, scalar networks, pdq block
+// partition), Tagged never does
+template<typename T>
+struct ArithmeticArrayStruct
+{
+	typedef T value_type;
+
+	T *d;
+	unsigned int n;
+};
+
+// true if the result isn't sorted or isn't the same keys bit for bit
+// (+inf and -0.0 must survive)
+template<typename T>
+bool fails(Algorithm<ArithmeticArrayStruct<T>> const &alg, std::vector<T> const &keys)
+{
+	std::vector<T> data(keys);
+	ArithmeticArrayStruct<T> ar { data.data(), (unsigned int)data.size() };
+	alg.sort(ar);
+
+	if(!std::is_sorted(data.begin(), data.end()))
+		return true;
+
+	auto bits = [](std::vector<T> const &v) {
+		std::vector<uint64_t> b(v.size(), 0);
+		for(size_t i = 0; i < v.size(); ++i)
+			std::memcpy(&b[i], &v[i], sizeof(T));
+		std::sort(b.begin(), b.end());
+		return b;
+	};
+	return bits(data) != bits(keys);
+}
+
+// shapes of generate() scaled to T, some keys replaced by extremes
+// (infinities, -0.0, denormals for floating point)
+template<typename T>
+std::vector<T> generate_arithmetic(std::mt19937_64 &rng, size_t maxsize)
+{
+	typedef std::numeric_limits<T> limits;
+
+	std::vector<int> const shape = generate(rng, maxsize);
+	std::vector<T> keys(shape.size());
+	for(size_t i = 0; i < shape.size(); ++i) {
+		if constexpr(std::is_floating_point<T>::value)
+			keys[i] = T(shape[i]) / 4;
+		else
+			keys[i] = T(shape[i]) * (T(1) << (sizeof(T)*8 - 32));
+	}
+
+	T specials[] = { limits::max(), limits::lowest(), T(0), T(-1) };
+	if(limits::has_infinity) {
+		specials[0] = limits::infinity();
+		specials[1] = -limits::infinity();
+		specials[2] = -T(0);
+		specials[3] = limits::denorm_min();
+	}
+	if(rng() % 2)
+		for(auto &k : keys)
+			if(rng() % 8 == 0)
+				k = specials[rng() % 4];
+	return keys;
+}
+
+template<typename T>
+std::vector<std::vector<T>> arithmetic_edges()
+{
+	typedef std::numeric_limits<T> limits;
+
+	std::vector<std::vector<T>> edges {
+		{}, {T(1)}, {limits::max(), limits::lowest(), T(0)},
+		{limits::lowest(), limits::max()}
+	};
+	if(limits::has_infinity) {
+		T const inf = limits::infinity();
+		edges.push_back({ T(3), inf, T(1), T(2), T(0) });
+		edges.push_back({ inf, T(1), T(-1) });
+		edges.push_back({ inf, -inf, T(0), -T(0), inf, T(0), -T(0), -inf });
+		edges.push_back(std::vector<T>(100, inf));
+		edges.push_back(std::vector<T>(100, -T(0)));
+	}
+	return edges;
+}
+
+template<typename T>
+int fuzz_arithmetic(Options const &options, std::string const &name, uint64_t seed)
+{
+	std::vector<Algorithm<ArithmeticArrayStruct<T>>> algs;
+	for(auto const &a : algorithms<ArithmeticArrayStruct<T>>())
+		if(!a.select && (name.empty() || name == a.name))
+			algs.push_back(a);
+
+	size_t const iterations = options.get("iterations", 1000ul);
+	size_t const maxsize = options.get("maxsize", 2000ul);
+	std::vector<std::vector<T>> const edges = arithmetic_edges<T>();
+
+	for(auto const &alg : algs) {
+		for(size_t c = 0; c < edges.size() + iterations; ++c) {
+			std::vector<T> keys;
+			if(c < edges.size()) {
+				keys = edges[c];
+			}
+			else {
+				std::mt19937_64 rng(seed ^ (c * 0x9e3779b97f4a7c15ull));
+				keys = generate_arithmetic<T>(rng, maxsize);
+			}
+			if(!fails(alg, keys))
+				continue;
+
+			cout << ElementTraits<T>::name() << " " << alg.name <<
+				": FAILED on " << keys.size() << " elements" << endl;
+			if(keys.size() <= 64)
+				cout << "input: " << keys << endl;
+			return EXIT_FAILURE;
+		}
+	}
+	cout << ElementTraits<T>::name() << ": " << algs.size() << " algorithms ok" << endl;
+	return 0;
+}
+
+// every arithmetic type of the fast paths, selection algorithms
+// are checked on Tagged only
+int fuzz_arithmetic(Options const &options, std::string const &name)
+{
+	uint64_t const seed = options.get(
+		"seed", (unsigned long)chrono::system_clock::now().time_since_epoch().count()
+	);
+	cout << "arithmetic: seed " << seed << ", " <<
+		options.get("iterations", 1000ul) << " cases per algorithm and type" << endl;
+
+	int result = fuzz_arithmetic<int>(options, name, seed);
+	if(result == 0)
+		result = fuzz_arithmetic<int64_t>(options, name, seed);
+	if(result == 0)
+		result = fuzz_arithmetic<float>(options, name, seed);
+	if(result == 0)
+		result = fuzz_arithmetic<double>(options, name, seed);
+	return result;
+}
+
+
+
+// string sorts on strings of few letters with shared prefixes;
+// every string has its own copy, so order of equal strings shows
+// stability
+struct CStringArrayStruct
+{
+	typedef CString value_type;
+
+	CString *d;
+	unsigned int n;
+};
+
+typedef Algorithm<CStringArrayStruct> string_algorithm_type;
+
+bool fails(string_algorithm_type const &alg, std::vector<std::string> const &strings)
+{
+	std::vector<CString> data(strings.size()), expected;
+	for(size_t i = 0; i < strings.size(); ++i)
+		data[i].s = (unsigned char const *)strings[i].c_str();
+
+	expected = data;
+	std::stable_sort(expected.begin(), expected.end());
+
+	CStringArrayStruct ar { data.data(), (unsigned int)data.size() };
+	alg.sort(ar);
+
+	auto byaddress = [](CString const &l, CString const &r) { return l.s < r.s; };
+	for(size_t i = 0; i < data.size(); ++i)
+		if(expected[i] < data[i] || data[i] < expected[i])
+			return true;
+	if(!alg.stable) {
+		std::sort(data.begin(), data.end(), byaddress);
+		std::sort(expected.begin(), expected.end(), byaddress);
+	}
+	for(size_t i = 0; i < data.size(); ++i)
+		if(data[i].s != expected[i].s)
+			return true;
+	return false;
+}
+
+std::vector<std::string> generate_strings(std::mt19937_64 &rng, size_t maxsize)
+{
+	std::vector<std::string> strings(rng() % 4 ? rng() % 64 : rng() % (maxsize + 1));
+	std::string const prefix(rng() % 40, char('a' + rng() % 26));
+	size_t const letters = 1 + rng() % 4, maxlength = rng() % 12;
+	for(auto &s : strings) {
+		if(rng() % 2)
+			s = prefix;
+		for(size_t l = rng() % (maxlength + 1); l > 0; --l)
+			s.push_back(char('a' + rng() % letters));
+		if(rng() % 16 == 0)
+			s.push_back(char(0x80 + rng() % 0x80));
+	}
+	return strings;
+}
+
+int fuzz_strings(Options const &options, std::string const &name)
+{
+	std::vector<string_algorithm_type> algs;
+	for(auto const &a : string_algorithms<CStringArrayStruct>())
+		if(name.empty() || name == a.name)
+			algs.push_back(a);
+
+	size_t const iterations = options.get("iterations", 1000ul);
+	size_t const maxsize = options.get("maxsize", 2000ul);
+	uint64_t const seed = options.get(
+		"seed", (unsigned long)chrono::system_clock::now().time_since_epoch().count()
+	);
+	cout << "strings: seed " << seed << ", " << iterations << " cases per algorithm" << endl;
+
+	for(auto const &alg : algs) {
+		for(size_t c = 0; c < iterations; ++c) {
+			std::mt19937_64 rng(seed ^ (c * 0x9e3779b97f4a7c15ull));
+			std::vector<std::string> const strings = generate_strings(rng, maxsize);
+			if(!fails(alg, strings))
+				continue;
+
+			cout << alg.name << ": FAILED on " << strings.size() << " strings" << endl;
+			if(strings.size() <= 64)
+				cout << "input: " << strings << endl;
+			return EXIT_FAILURE;
+		}
+		cout << alg.name << (alg.stable ? " (stable)" : "") << ": ok" << endl;
+	}
+	return 0;
+}
+
+
+
+// keys written by KeyDump::write come back unchanged: replay: gives
+// all of them in order, sample: a subsequence in file order
+template<typename Key>
+bool key_dump_fails(std::string const &file, std::vector<Key> const &keys, std::mt19937_64 &rng)
+{
+	if(!KeyDump::write(file, keys.data(), keys.size()))
+		return true;
+
+	Distribution replay;
+	if(!replay.parse("replay:" + file) || replay.maxSize() != keys.size())
+		return true;
+	std::vector<Key> out(keys.size());
+	replay.fill(out.data(), out.size(), rng);
+	if(out != keys)
+		return true;
+
+	Distribution sample;
+	if(!sample.parse("sample:" + file))
+		return true;
+	out.resize(rng() % (keys.size() + 1));
+	sample.fill(out.data(), out.size(), rng);
+	size_t j = 0;
+	for(Key const k : out) {
+		while(j < keys.size() && keys[j] != k)
+			++j;
+		if(j++ == keys.size())
+			return true;
+	}
+	return false;
+}
+
+template<typename Key>
+int fuzz_key_dump(std::string const &file, size_t iterations, size_t maxsize, uint64_t seed)
+{
+	static char const *const NAMES[] = {
+		"random", "sorted", "reversed", "duplicates:4", "zipf:1.5"
+	};
+	for(size_t c = 0; c < iterations; ++c) {
+		std::mt19937_64 rng(seed ^ (c * 0x9e3779b97f4a7c15ull));
+		Distribution d;
+		d.parse(NAMES[rng() % (sizeof NAMES / sizeof *NAMES)]);
+		std::vector<Key> keys(rng() % (maxsize + 1));
+		d.fill(keys.data(), keys.size(), rng);
+		for(auto &k : keys)
+			if(rng() % 8 == 0)
+				k = rng() % 2 ? std::numeric_limits<Key>::max() : std::numeric_limits<Key>::min() + Key(rng() % 4);
+			else if(rng() % 2)
+				k = -k;
+		if(!key_dump_fails(file, keys, rng))
+			continue;
+
+		cout << "key dump of " << sizeof(Key) << "-byte keys: FAILED on " <<
+			keys.size() << " keys" << endl;
+		if(keys.size() <= 64)
+			cout << "input: " << keys << endl;
+		return EXIT_FAILURE;
+	}
+	return 0;
+}
+
+int fuzz_key_dump(Options const &options)
+{
+	size_t const iterations = options.get("iterations", 1000ul) / 10 + 1;
+	size_t const maxsize = options.get("maxsize", 2000ul);
+	uint64_t const seed = options.get(
+		"seed", (unsigned long)chrono::system_clock::now().time_since_epoch().count()
+	);
+
+	char file[] = "/tmp/check_keysXXXXXX";
+	int const fd = mkstemp(file);
+	if(fd < 0) {
+		cerr << "can't create '" << file << "'" << endl;
+		return EXIT_FAILURE;
+	}
+	close(fd);
+	int result = fuzz_key_dump<int32_t>(file, iterations, maxsize, seed);
+	if(result == 0)
+		result = fuzz_key_dump<int64_t>(file, iterations, maxsize, seed);
+	unlink(file);
+
+	if(result == 0)
+		cout << "key dump: seed " << seed << ", " << iterations << " cases per key size ok" << endl;
+	return result;
+}
+
+
+
+int fuzz(Options const &options)
+{
+	parallel_sort_settings().cutoff = std::max(1ul, options.get("cutoff", 16ul));
+	parallel_sort_settings().samplebase = options.get("samplebase", 256ul);
+	parallel_sort_settings().threads = std::max(4u, std::thread::hardware_concurrency());
+
+	// algorithms
+	std::vector<tagged_algorithm_type> algs;
+	std::string const name = options.get("algorithm", DEFAULT_ALGORITHM);
+	if(options.has("algorithm")) {
+		auto *alg = find_algorithm<TaggedArrayStruct>(name);
+		for(auto const &a : string_algorithms<CStringArrayStruct>())
+			if(!alg && name == a.name)
+				return fuzz_strings(options, name);
+		if(!alg) {
+			cerr << "unknown algorithm '" << name << "'" << endl;
+			return EXIT_FAILURE;
+		}
+		algs.push_back(*alg);
+	}
+	else {
+		algs = algorithms<TaggedArrayStruct>();
+	}
+
+
+	// settings
+	size_t const iterations = options.get("iterations", 1000ul);
+	size_t const maxsize = options.get("maxsize", 2000ul);
+	uint64_t const seed = options.get(
+		"seed", (unsigned long)chrono::system_clock::now().time_since_epoch().count()
+	);
+	size_t threadcount = options.get(
+		"threads", (unsigned long)std::thread::hardware_concurrency()
+	);
+	if(threadcount == 0)
+		threadcount = 1;
+
+	cout << "seed " << seed << ", " << iterations << " cases per algorithm, " <<
+		threadcount << " threads" << endl;
+
+
+	// edge cases first: n = 0, 1, 2 and all-equal keys
+	std::vector<std::vector<int>> edges {
+		{}, {0}, {-1}, {1, 0}, {0, 1}, {5, 5}, {INT_MAX, INT_MIN},
+		std::vector<int>(100, 7), std::vector<int>(100, -7)
+	};
+
+
+	// every case has its own generator, seed ^ case number,
+	// so a failure can be reproduced with any thread count
+	std::atomic<size_t> next(0);
+	std::atomic<bool> stop(false);
+	std::mutex mutex;
+	size_t failalg = 0, failk = 0;
+	std::vector<int> failkeys;
+	size_t const total = algs.size() * (edges.size() + iterations);
+
+	auto worker = [&]() {
+		for(size_t item; !stop && (item = next++) < total; ) {
+			size_t const a = item % algs.size();
+			size_t const c = item / algs.size();
+
+			// rank of selection: ends, median or any
+			std::vector<int> keys;
+			size_t k;
+			if(c < edges.size()) {
+				keys = edges[c];
+				k = keys.size()/2;
+			}
+			else {
+				std::mt19937_64 rng(seed ^ (item * 0x9e3779b97f4a7c15ull));
+				keys = generate(rng, maxsize);
+				size_t const n = keys.size();
+				size_t const ks[] = { 0, n/2, n, rng() % (n+1) };
+				k = ks[rng() % 4];
+			}
+
+			if(fails(algs[a], keys, k)) {
+				std::lock_guard<std::mutex> lock(mutex);
+				if(!stop) {
+					failalg = a;
+					failk = k;
+					failkeys = keys;
+					stop = true;
+				}
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for(size_t i = 1; i < threadcount; ++i)
+		threads.emplace_back(worker);
+	worker();
+	for(auto &t : threads)
+		t.join();
+
+
+	// report
+	if(!stop) {
+		for(auto const &a : algs)
+			cout << a.name << (a.stable ? " (stable)" : "") << ": ok" << endl;
+		int const result = fuzz_arithmetic(options, options.has("algorithm") ? name : "");
+		if(result != 0 || options.has("algorithm"))
+			return result;
+		if(fuzz_strings(options, "") != 0)
+			return EXIT_FAILURE;
+		return fuzz_key_dump(options);
+	}
+
+	auto const &alg = algs[failalg];
+	cout << alg.name << ": FAILED on " << failkeys.size() << " elements" << endl;
+	failkeys = shrink(alg, failkeys, failk);
+	cout << "minimal input: " << failkeys << endl;
+
+	std::vector<Tagged> data(failkeys.size());
+	for(size_t i = 0; i < failkeys.size(); ++i)
+		data[i] = { failkeys[i], (unsigned int)i };
+	TaggedArrayStruct ar { data.data(), (unsigned int)data.size() };
+	if(!alg.select) {
+		alg.sort(ar);
+	}
+	else if(!data.empty()) {
+		failk = std::min(failk, alg.topk ? data.size() : data.size()-1);
+		cout << "k: " << failk << endl;
+		alg.select(ar, failk);
+	}
+
+	std::vector<int> keys, positions;
+	for(auto const &t : data) {
+		keys.push_back(t.key);
+		positions.push_back(t.tag);
+	}
+	cout << "result keys: " << keys << endl;
+	cout << "result positions: " << positions << endl;
+
+	return EXIT_FAILURE;
+}
+
+
+
+int demo(Options const &options)
 {
 	constexpr unsigned int const VECTOR_SIZE = 20u;
 
+	std::string const name = options.get("algorithm", DEFAULT_ALGORITHM);
+	auto *alg = find_algorithm<random_array_type>(name);
+	if(!alg) {
+		cerr << "unknown algorithm '" << name << "'" << endl;
+		return EXIT_FAILURE;
+	}
+
 
 	// fill
 	default_random_engine dre( time(0) );
@@ -60,10 +904,11 @@ int main( int argc, char *argv[] )
 	std::cout << "before: " << vec << std::endl;
 
 		// testing
-	data_type data;
+	random_array_type data;
+	delete[] data.d;
 	data.d = vec.data();
 	data.n = vec.size();
-	algorithm(data);
+	alg->sort(data);
 	data.d = nullptr;
 
 	std::cout << "after: " << vec << std::endl;
@@ -71,3 +916,13 @@ int main( int argc, char *argv[] )
 
 	return 0;
 }
+
+
+
+
+
+int main( int argc, char *argv[] )
+{
+	Options options(argc, argv);
+	return options.has("fuzz") ? fuzz(options) : demo(options);
+}
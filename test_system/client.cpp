@@ -0,0 +1,115 @@
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "options.cpp"
+
+
+
+
+
+using namespace std;
+
+
+
+char const *DEFAULT_SOCKET_NAME = "/tmp/algorithm_test.sock";
+
+
+
+/*
+ * Client of the benchmark daemon (see daemon.cpp).
+ *
+ *         client [--socket=path] submit <algorithm> [maxn] [repeat] [distribution]
+ *         client [--socket=path] status
+ *         client [--socket=path] cancel <id>
+ *
+ * submit waits until the job is done and prints its progress.
+ */
+int main( int argc, char *argv[] )
+{
+	Options options(argc, argv);
+	std::string const socketname = options.get("socket", DEFAULT_SOCKET_NAME);
+	std::string const command = options.positional(0);
+
+	std::string request;
+	if(command == "submit" && options.positionalCount() >= 2) {
+		request = "submit " + options.positional(1) + " " +
+			options.positional(2, "4096") + " " +
+			options.positional(3, "50") + " " +
+			options.positional(4, "random");
+	}
+	else if(command == "status") {
+		request = "status";
+	}
+	else if(command == "cancel" && options.positionalCount() >= 2) {
+		request = "cancel " + options.positional(1);
+	}
+	else {
+		cerr << "usage: client [--socket=path] submit <algorithm> "
+			"[maxn] [repeat] [distribution]" << endl;
+		cerr << "       client [--socket=path] status" << endl;
+		cerr << "       client [--socket=path] cancel <id>" << endl;
+		return EXIT_FAILURE;
+	}
+
+
+	// connect
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	sockaddr_un addr;
+	memset(&addr, 0, sizeof addr);
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, socketname.c_str(), sizeof addr.sun_path - 1);
+
+	if(fd < 0 || connect(fd, (sockaddr *)&addr, sizeof addr) < 0) {
+		cerr << "can't connect to '" << socketname << "'" << endl;
+		return EXIT_FAILURE;
+	}
+
+	request += '\n';
+	if(write(fd, request.data(), request.size()) < 0) {
+		cerr << "can't send request" << endl;
+		return EXIT_FAILURE;
+	}
+
+
+	// wait answer
+	std::string input;
+	char buf[4096];
+	ssize_t n;
+	while((n = read(fd, buf, sizeof buf)) > 0) {
+		input.append(buf, n);
+
+		size_t pos;
+		while((pos = input.find('\n')) != std::string::npos) {
+			std::string const line = input.substr(0, pos);
+			input.erase(0, pos+1);
+			cout << line << endl;
+
+			if(
+				line.compare(0, 5, "done ") == 0 || line == "end" ||
+				line.compare(0, 10, "cancelled ") == 0
+			) {
+				close(fd);
+				return 0;
+			}
+			if(line.compare(0, 7, "failed ") == 0) {
+				close(fd);
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	cerr << "connection closed" << endl;
+	close(fd);
+	return EXIT_FAILURE;
+}
+
+
+
+
+
+// end
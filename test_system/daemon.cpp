@@ -0,0 +1,546 @@
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "options.cpp"
+#include "result_store.cpp"
+
+
+
+
+
+using namespace std;
+
+
+
+char const *DEFAULT_SOCKET_NAME = "/tmp/algorithm_test.sock";
+char const *DEFAULT_RESULTS_DIR = "results";
+
+
+
+/*
+ * Benchmark daemon.
+ *
+ *         daemon [--socket=path] [--cores=2,3] [--results=dir] [--bin=dir]
+ *
+ * Listens on a unix socket and runs sweep jobs one at a time.
+ * A job is a harness binary built by testing.sh (<bin>/<algorithm>),
+ * pinned to the reserved cores. The daemon itself moves off them.
+ * Finished runs are added to the result store in --results
+ * (see result_store.cpp).
+ *
+ * Protocol, one line per message:
+ *         -> submit <algorithm> <maxn> <repeat> <distribution>
+ *         <- queued <id> <jobs ahead>
+ *         <- progress <id> <harness output line>
+ *         <- done <id> <result file> | failed <id> <reason>
+ *
+ *         -> status
+ *         <- job <id> <algorithm> <running|queued>
+ *         <- end
+ *
+ *         -> cancel <id>
+ *         <- cancelled <id> | failed - unknown job '<id>'
+ *
+ * maxn >= 1 and repeat >= 3, as main.cpp checks. A cancelled running
+ * job is stopped by SIGTERM and reported as failed.
+ *
+ * Client sockets are non-blocking: replies wait in a buffer of the
+ * client, so one that stops reading never stalls the running job.
+ * A client whose buffer grows past MAX_CLIENT_BACKLOG is disconnected,
+ * its jobs keep running.
+ */
+
+
+
+
+
+// job
+struct Job
+{
+	std::string id;
+	std::string algorithm;
+	unsigned long maxn;
+	unsigned long repeat;
+	std::string distribution;
+
+	int client;
+	std::string resultfile;
+};
+
+
+
+// client connection
+struct Client
+{
+	std::string input;      // unread lines
+	std::string output;     // replies not sent yet
+};
+
+constexpr size_t const MAX_CLIENT_BACKLOG = 1u << 20;
+
+
+
+// state
+std::string bindir, resultsdir;
+cpu_set_t reserved;
+bool havereserved = false;
+
+int listenfd = -1;
+std::map<int, Client> clients;
+std::deque<Job> queue;
+
+bool running = false;
+Job current;
+pid_t child = -1;
+int childout = -1;
+std::string childbuf;
+
+unsigned long jobcounter = 0;
+
+
+
+
+
+// helper functions
+void drop_client(int fd)
+{
+	// client gone, its jobs keep running
+	close(fd);
+	clients.erase(fd);
+	for(auto &j : queue)
+		if(j.client == fd)
+			j.client = -1;
+	if(current.client == fd)
+		current.client = -1;
+	return;
+}
+
+// sends what the socket takes now, the rest waits for POLLOUT
+void flush_client(int fd)
+{
+	std::string &output = clients[fd].output;
+	while(!output.empty()) {
+		ssize_t n = send(fd, output.data(), output.size(), MSG_NOSIGNAL);
+		if(n < 0 && errno == EINTR)
+			continue;
+		if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			break;
+		if(n <= 0) {
+			drop_client(fd);
+			return;
+		}
+		output.erase(0, n);
+	}
+	if(output.size() > MAX_CLIENT_BACKLOG)
+		drop_client(fd);
+	return;
+}
+
+void send_line(int fd, std::string const &line)
+{
+	auto c = clients.find(fd);
+	if(c == clients.end())
+		return;
+	c->second.output += line;
+	c->second.output += '\n';
+	flush_client(fd);
+	return;
+}
+
+bool valid_name(std::string const &s, char const *extra = "")
+{
+	if(s.empty())
+		return false;
+	for(char ch : s)
+		if(!isalnum((unsigned char)ch) && ch != '_' && !strchr(extra, ch))
+			return false;
+	return true;
+}
+
+bool parse_cores(std::string const &s, cpu_set_t &set)
+{
+	CPU_ZERO(&set);
+	std::istringstream is(s);
+	std::string item;
+	bool any = false;
+	while(std::getline(is, item, ',')) {
+		if(item.empty())
+			continue;
+		char *end;
+		long core = strtol(item.c_str(), &end, 10);
+		if(*end != 0 || core < 0 || core >= CPU_SETSIZE)
+			return false;
+		CPU_SET(core, &set);
+		any = true;
+	}
+	return any;
+}
+
+
+
+
+
+// jobs
+void start_next()
+{
+	if(running || queue.empty())
+		return;
+
+	current = queue.front();
+	queue.pop_front();
+
+	current.resultfile = resultsdir + "/" + current.id + "-" +
+		current.algorithm + "-" + current.distribution + ".chart";
+
+	int fds[2];
+	if(pipe2(fds, O_CLOEXEC) < 0) {
+		send_line(current.client, "failed " + current.id + " pipe");
+		return start_next();
+	}
+
+	child = fork();
+	if(child < 0) {
+		close(fds[0]);
+		close(fds[1]);
+		send_line(current.client, "failed " + current.id + " fork");
+		return start_next();
+	}
+
+	if(child == 0) {
+		dup2(fds[1], STDOUT_FILENO);
+		dup2(fds[1], STDERR_FILENO);
+		close(fds[0]);
+		close(fds[1]);
+
+		if(havereserved)
+			sched_setaffinity(0, sizeof reserved, &reserved);
+
+		std::string const bin = bindir + "/" + current.algorithm;
+		std::string const maxn = "--maxn=" + std::to_string(current.maxn);
+		std::string const repeat = "--repeat=" + std::to_string(current.repeat);
+		std::string const dist = "--distribution=" + current.distribution;
+		char const *args[] = {
+			bin.c_str(), current.resultfile.c_str(),
+			maxn.c_str(), repeat.c_str(), dist.c_str(), nullptr
+		};
+		execv(bin.c_str(), (char * const *)args);
+		std::cout << "can't exec '" << bin << "'" << std::endl;
+		_exit(127);
+	}
+
+	close(fds[1]);
+	fcntl(fds[0], F_SETFL, O_NONBLOCK);
+	childout = fds[0];
+	childbuf.clear();
+	running = true;
+
+	send_line(current.client, "progress " + current.id + " started");
+	return;
+}
+
+void finish_current()
+{
+	int status = 0;
+	waitpid(child, &status, 0);
+	close(childout);
+	childout = -1;
+	child = -1;
+	running = false;
+
+	bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+
+	// move result into the store
+	std::string stored = "-";
+	if(ok) {
+		ResultStore store(resultsdir);
+		uint64_t id = store.add(
+			current.resultfile, current.algorithm, current.distribution
+		);
+		unlink(current.resultfile.c_str());
+		unlink((current.resultfile + ".info").c_str());
+		if(id)
+			stored = store.runFileName(id);
+		else
+			ok = false;
+	}
+
+	// journal of all jobs
+	{
+		ofstream log(resultsdir + "/jobs.log", ofstream::app);
+		log << current.id << ' ' << current.algorithm << ' ' <<
+			current.maxn << ' ' << current.repeat << ' ' <<
+			current.distribution << ' ' << stored << '\n';
+	}
+
+	if(ok)
+		send_line(current.client, "done " + current.id + " " + stored);
+	else if(WIFEXITED(status) && WEXITSTATUS(status) == 0)
+		send_line(current.client, "failed " + current.id + " store");
+	else if(WIFEXITED(status))
+		send_line(current.client, "failed " + current.id + " exit " +
+			std::to_string(WEXITSTATUS(status)));
+	else
+		send_line(current.client, "failed " + current.id + " signal " +
+			std::to_string(WTERMSIG(status)));
+
+	start_next();
+	return;
+}
+
+void read_child()
+{
+	char buf[4096];
+	ssize_t n = read(childout, buf, sizeof buf);
+	if(n < 0 && (errno == EAGAIN || errno == EINTR))
+		return;
+	if(n <= 0) {
+		if(!childbuf.empty())
+			send_line(current.client, "progress " + current.id + " " + childbuf);
+		finish_current();
+		return;
+	}
+
+	childbuf.append(buf, n);
+	size_t pos;
+	while((pos = childbuf.find('\n')) != std::string::npos) {
+		send_line(
+			current.client,
+			"progress " + current.id + " " + childbuf.substr(0, pos)
+		);
+		childbuf.erase(0, pos+1);
+	}
+	return;
+}
+
+
+
+
+
+// clients
+void handle_command(int fd, std::string const &line)
+{
+	std::istringstream is(line);
+	std::string command;
+	is >> command;
+
+	if(command == "submit") {
+		Job job;
+		long maxn = 0, repeat = 0;
+		is >> job.algorithm >> maxn >> repeat >> job.distribution;
+		if(
+			!is || maxn < 1 || repeat < 3 || !valid_name(job.algorithm) ||
+			!valid_name(job.distribution, ":.") ||
+			job.algorithm.size() >= sizeof(IndexRecord::algorithm) ||
+			job.distribution.size() >= sizeof(IndexRecord::distribution)
+		) {
+			send_line(fd, "failed - bad request");
+			return;
+		}
+		if(access((bindir + "/" + job.algorithm).c_str(), X_OK) != 0) {
+			send_line(fd, "failed - unknown algorithm '" + job.algorithm + "'");
+			return;
+		}
+
+		job.maxn = maxn;
+		job.repeat = repeat;
+		job.id = std::to_string(time(nullptr)) + "_" +
+			std::to_string(++jobcounter);
+		job.client = fd;
+
+		size_t const ahead = queue.size() + (running ? 1 : 0);
+		queue.push_back(job);
+		send_line(fd, "queued " + job.id + " " + std::to_string(ahead));
+		start_next();
+	}
+	else if(command == "status") {
+		if(running)
+			send_line(fd, "job " + current.id + " " +
+				current.algorithm + " running");
+		for(auto const &j : queue)
+			send_line(fd, "job " + j.id + " " + j.algorithm + " queued");
+		send_line(fd, "end");
+	}
+	else if(command == "cancel") {
+		std::string id;
+		is >> id;
+		if(running && current.id == id) {
+			kill(child, SIGTERM);
+			send_line(fd, "cancelled " + id);
+			return;
+		}
+		for(auto j = queue.begin(); j != queue.end(); ++j) {
+			if(j->id != id)
+				continue;
+			int const client = j->client;
+			queue.erase(j);
+			send_line(client, "failed " + id + " cancelled");
+			send_line(fd, "cancelled " + id);
+			return;
+		}
+		send_line(fd, "failed - unknown job '" + id + "'");
+	}
+	else {
+		send_line(fd, "failed - unknown command '" + command + "'");
+	}
+
+	return;
+}
+
+void read_client(int fd)
+{
+	char buf[1024];
+	ssize_t n = read(fd, buf, sizeof buf);
+	if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+		return;
+	if(n <= 0) {
+		drop_client(fd);
+		return;
+	}
+
+	clients[fd].input.append(buf, n);
+	size_t pos;
+	while(
+		clients.count(fd) &&
+		(pos = clients[fd].input.find('\n')) != std::string::npos
+	) {
+		std::string line = clients[fd].input.substr(0, pos);
+		clients[fd].input.erase(0, pos+1);
+		handle_command(fd, line);
+	}
+	return;
+}
+
+
+
+
+
+// main
+int main( int argc, char *argv[] )
+{
+	Options options(argc, argv);
+	std::string const socketname = options.get("socket", DEFAULT_SOCKET_NAME);
+	bindir = options.get("bin", ".");
+	resultsdir = options.get("results", DEFAULT_RESULTS_DIR);
+
+
+	// reserved cores
+	if(options.has("cores")) {
+		if(!parse_cores(options.get("cores"), reserved)) {
+			cerr << "invalid core list '" << options.get("cores") << "'" << endl;
+			return EXIT_FAILURE;
+		}
+		havereserved = true;
+
+		// keep the daemon itself away from reserved cores
+		cpu_set_t rest;
+		CPU_ZERO(&rest);
+		for(int i = 0, e = sysconf(_SC_NPROCESSORS_ONLN); i < e; ++i)
+			if(!CPU_ISSET(i, &reserved))
+				CPU_SET(i, &rest);
+		if(CPU_COUNT(&rest) > 0)
+			sched_setaffinity(0, sizeof rest, &rest);
+	}
+
+	if(!ResultStore(resultsdir).open()) {
+		cerr << "can't open result store '" << resultsdir << "'" << endl;
+		return EXIT_FAILURE;
+	}
+
+
+	// socket
+	{
+		sockaddr_un addr;
+		memset(&addr, 0, sizeof addr);
+		addr.sun_family = AF_UNIX;
+		if(socketname.size() >= sizeof addr.sun_path) {
+			cerr << "socket name too long" << endl;
+			return EXIT_FAILURE;
+		}
+		strcpy(addr.sun_path, socketname.c_str());
+
+		listenfd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		unlink(socketname.c_str());
+		if(
+			listenfd < 0 ||
+			bind(listenfd, (sockaddr *)&addr, sizeof addr) < 0 ||
+			listen(listenfd, 16) < 0
+		) {
+			cerr << "can't listen on '" << socketname << "': " <<
+				strerror(errno) << endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	signal(SIGPIPE, SIG_IGN);
+	cout << "listening on " << socketname << endl;
+
+
+	// loop
+	std::vector<pollfd> fds;
+	while(true) {
+		fds.clear();
+		fds.push_back({ listenfd, POLLIN, 0 });
+		if(running)
+			fds.push_back({ childout, POLLIN, 0 });
+		for(auto const &c : clients)
+			fds.push_back({
+				c.first, short(POLLIN | (c.second.output.empty() ? 0 : POLLOUT)), 0
+			});
+
+		if(poll(fds.data(), fds.size(), -1) < 0) {
+			if(errno == EINTR)
+				continue;
+			cerr << "poll: " << strerror(errno) << endl;
+			break;
+		}
+
+		for(auto const &p : fds) {
+			if(p.fd == listenfd) {
+				if(!(p.revents & POLLIN))
+					continue;
+				int fd = accept4(
+					listenfd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK
+				);
+				if(fd >= 0)
+					clients[fd];
+			}
+			else if(running && p.fd == childout) {
+				if(p.revents & (POLLIN | POLLHUP | POLLERR))
+					read_child();
+			}
+			else if(clients.count(p.fd)) {
+				if(p.revents & POLLOUT)
+					flush_client(p.fd);
+				if(clients.count(p.fd) && (p.revents & (POLLIN | POLLHUP | POLLERR)))
+					read_client(p.fd);
+			}
+		}
+	}
+
+	unlink(socketname.c_str());
+	return EXIT_FAILURE;
+}
+
+
+
+
+
+// end
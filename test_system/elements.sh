@@ -0,0 +1,28 @@
+#!/bin/bash
+
+# every algorithm on every element type from elements.cpp,
+# results go to the store tagged with element (see store.cpp)
+#
+#         elements.sh [maxn] [repeat] [distribution]
+
+MAXN=${1:-1024}
+REPEAT=${2:-20}
+DISTRIBUTION=${3:-random}
+ALGORITHMS="bubble_sort selection_sort insertion_sort merge_sort pingpong_merge_sort kernel_merge_sort network_merge_sort radix_sort radix11_sort pdq_sort std_sort std_stable_sort grail_sort grail_cache_sort power_sort insertion_sort_function_compare merge_sort_function_compare pdq_sort_function_compare power_sort_function_compare grail_sort_function_compare indirect_pdq_sort indirect_pdq_cycle_sort indirect_radix_sort indirect_radix_cycle_sort parallel_merge_sort sample_sort"
+ELEMENTS="int int64_t float double record16 record32 record64 record128 record256 record512 record1024 KeyPointer"
+
+g++ -O2 -o store store.cpp || exit 1
+mkdir -p build/elements
+
+for ELEMENT in $ELEMENTS; do
+	for ALG in $ALGORITHMS; do
+		BIN=build/elements/$ALG-$ELEMENT
+		echo "$ELEMENT: $ALG"
+		g++ -O3 -pthread -I../lib -D${ALG^^} -DELEMENT_TYPE=$ELEMENT -o $BIN main.cpp || continue
+		$BIN $BIN.chart --maxn=$MAXN --repeat=$REPEAT \
+			--distribution=$DISTRIBUTION > /dev/null || continue
+		./store add $BIN.chart $ALG $DISTRIBUTION > /dev/null
+	done
+done
+
+./store query --latest --host=this --distribution=$DISTRIBUTION
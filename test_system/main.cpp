@@ -1,36 +1,471 @@
 #include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
 
+#include <clever/Profiler.hpp>
 #include <clever/Stopwatch.hpp>
 
+#include "options.cpp"
+#include "run_info.cpp"
+
+#include "structures/linked_list.cpp"
+#include "structures/random_array.cpp"
+
+// element type of input: -DELEMENT_TYPE=record64, see elements.cpp
+#ifndef ELEMENT_TYPE
+	#define ELEMENT_TYPE int
+#endif
+
+#ifdef MEMORY_TRACE
+	#include "memory_trace.cpp"
+#endif
+
+#ifdef CACHE_TRACE
+	#include "cache_trace.cpp"
+	typedef TracedArrayStruct<ELEMENT_TYPE> traced_array_type;
+#endif
+
 
 
 #ifdef SELECTION_SORT
 	#include "sort/selection_sort.cpp"
-	typedef random_array_type data_type;
+	typedef array_type<ELEMENT_TYPE> data_type;
 	constexpr void(*algorithm)(data_type &) = &selection_sort;
+	char const *ALGORITHM_NAME = "selection_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &selection_sort;
+#endif
 
 #elif INSERTION_SORT
 	#include "sort/insertion_sort.cpp"
-	typedef random_array_type data_type;
+	typedef array_type<ELEMENT_TYPE> data_type;
 	constexpr void(*algorithm)(data_type &) = &insertion_sort;
+	char const *ALGORITHM_NAME = "insertion_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &insertion_sort;
+#endif
 
 #elif BUBBLE_SORT
 	#include "sort/bubble_sort.cpp"
-	typedef random_array_type data_type;
+	typedef array_type<ELEMENT_TYPE> data_type;
 	constexpr void(*algorithm)(data_type &) = &bubble_sort;
+	char const *ALGORITHM_NAME = "bubble_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &bubble_sort;
+#endif
 
 #elif MERGE_SORT
 	#include "sort/merge_sort.cpp"
-	typedef random_array_type data_type;
+	typedef array_type<ELEMENT_TYPE> data_type;
 	constexpr void(*algorithm)(data_type &) = &merge_sort;
+	char const *ALGORITHM_NAME = "merge_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &merge_sort;
+#endif
+
+#elif PINGPONG_MERGE_SORT
+	#include "sort/pingpong_merge_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &pingpong_merge_sort;
+	char const *ALGORITHM_NAME = "pingpong_merge_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &pingpong_merge_sort;
+#endif
+
+#elif KERNEL_MERGE_SORT
+	#include "sort/merge_kernel.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &kernel_merge_sort;
+	char const *ALGORITHM_NAME = "kernel_merge_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &kernel_merge_sort;
+#endif
+
+#elif NETWORK_SORT
+	#include "sort/network_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &network_sort;
+	char const *ALGORITHM_NAME = "network_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &network_sort;
+#endif
+
+#elif NETWORK_MERGE_SORT
+	#include "sort/network_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &network_merge_sort;
+	char const *ALGORITHM_NAME = "network_merge_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &network_merge_sort;
+#endif
+
+#elif RADIX_SORT
+	#include "sort/radix_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &radix_sort;
+	char const *ALGORITHM_NAME = "radix_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &radix_sort;
+#endif
+
+#elif RADIX11_SORT
+	#include "sort/radix_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &radix11_sort;
+	char const *ALGORITHM_NAME = "radix11_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &radix11_sort;
+#endif
+
+#elif PDQ_SORT
+	#include "sort/pdq_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &pdq_sort;
+	char const *ALGORITHM_NAME = "pdq_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &pdq_sort;
+#endif
+
+#elif STD_SORT
+	#include "sort/std_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &std_sort;
+	char const *ALGORITHM_NAME = "std_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &std_sort;
+#endif
+
+#elif STD_STABLE_SORT
+	#include "sort/std_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &std_stable_sort;
+	char const *ALGORITHM_NAME = "std_stable_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &std_stable_sort;
+#endif
+
+#elif GRAIL_SORT
+	#include "sort/block_merge_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &grail_sort;
+	char const *ALGORITHM_NAME = "grail_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &grail_sort;
+#endif
+
+#elif GRAIL_CACHE_SORT
+	#include "sort/block_merge_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &grail_cache_sort;
+	char const *ALGORITHM_NAME = "grail_cache_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &grail_cache_sort;
+#endif
+
+#elif POWER_SORT
+	#include "sort/power_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &power_sort;
+	char const *ALGORITHM_NAME = "power_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &power_sort;
+#endif
+
+#elif INSERTION_SORT_FUNCTION_COMPARE
+	#include "sort/insertion_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &insertion_sort_function_compare;
+	char const *ALGORITHM_NAME = "insertion_sort_function_compare";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &insertion_sort_function_compare;
+#endif
+
+#elif MERGE_SORT_FUNCTION_COMPARE
+	#include "sort/merge_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &merge_sort_function_compare;
+	char const *ALGORITHM_NAME = "merge_sort_function_compare";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &merge_sort_function_compare;
+#endif
+
+#elif PDQ_SORT_FUNCTION_COMPARE
+	#include "sort/pdq_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &pdq_sort_function_compare;
+	char const *ALGORITHM_NAME = "pdq_sort_function_compare";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &pdq_sort_function_compare;
+#endif
+
+#elif POWER_SORT_FUNCTION_COMPARE
+	#include "sort/power_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &power_sort_function_compare;
+	char const *ALGORITHM_NAME = "power_sort_function_compare";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &power_sort_function_compare;
+#endif
+
+#elif GRAIL_SORT_FUNCTION_COMPARE
+	#include "sort/block_merge_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &grail_sort_function_compare;
+	char const *ALGORITHM_NAME = "grail_sort_function_compare";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &grail_sort_function_compare;
+#endif
+
+#elif INDIRECT_PDQ_SORT
+	#include "sort/indirect_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &indirect_pdq_sort;
+	char const *ALGORITHM_NAME = "indirect_pdq_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &indirect_pdq_sort;
+#endif
+
+#elif INDIRECT_PDQ_CYCLE_SORT
+	#include "sort/indirect_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &indirect_pdq_cycle_sort;
+	char const *ALGORITHM_NAME = "indirect_pdq_cycle_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &indirect_pdq_cycle_sort;
+#endif
+
+#elif INDIRECT_RADIX_SORT
+	#include "sort/indirect_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &indirect_radix_sort;
+	char const *ALGORITHM_NAME = "indirect_radix_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &indirect_radix_sort;
+#endif
+
+#elif INDIRECT_RADIX_CYCLE_SORT
+	#include "sort/indirect_sort.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &indirect_radix_cycle_sort;
+	char const *ALGORITHM_NAME = "indirect_radix_cycle_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &indirect_radix_cycle_sort;
+#endif
+
+#elif PARALLEL_MERGE_SORT
+	#include "sort/merge_sort.cpp"
+	#include "sort/parallel_merge_sort.cpp"
+	#define PARALLEL_SORT
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &parallel_merge_sort;
+	constexpr void(*baseline_algorithm)(data_type &) = &merge_sort;
+	char const *ALGORITHM_NAME = "parallel_merge_sort";
+
+#elif SAMPLE_SORT
+	#include "sort/merge_sort.cpp"
+	#include "sort/sample_sort.cpp"
+	#define PARALLEL_SORT
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &sample_sort;
+	constexpr void(*baseline_algorithm)(data_type &) = &merge_sort;
+	char const *ALGORITHM_NAME = "sample_sort";
+
+#elif QUICK_SELECT
+	#include "sort/select.cpp"
+	#define SELECT_RANK
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &quick_select;
+	char const *ALGORITHM_NAME = "quick_select";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &quick_select;
+#endif
+
+#elif INTRO_SELECT
+	#include "sort/select.cpp"
+	#define SELECT_RANK
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &intro_select;
+	char const *ALGORITHM_NAME = "intro_select";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &intro_select;
+#endif
+
+#elif FLOYD_RIVEST_SELECT
+	#include "sort/select.cpp"
+	#define SELECT_RANK
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &floyd_rivest_select;
+	char const *ALGORITHM_NAME = "floyd_rivest_select";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &floyd_rivest_select;
+#endif
+
+#elif MEDIAN_OF_MEDIANS_SELECT
+	#include "sort/select.cpp"
+	#define SELECT_RANK
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &median_of_medians_select;
+	char const *ALGORITHM_NAME = "median_of_medians_select";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &median_of_medians_select;
+#endif
+
+#elif STD_NTH_ELEMENT
+	#include "sort/select.cpp"
+	#define SELECT_RANK
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &std_nth_element;
+	char const *ALGORITHM_NAME = "std_nth_element";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &std_nth_element;
+#endif
+
+#elif HEAP_TOP_K
+	#include "sort/top_k.cpp"
+	#define SELECT_RANK
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &heap_top_k;
+	char const *ALGORITHM_NAME = "heap_top_k";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &heap_top_k;
+#endif
+
+#elif PARTIAL_QUICK_SORT
+	#include "sort/top_k.cpp"
+	#define SELECT_RANK
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &partial_quick_sort;
+	char const *ALGORITHM_NAME = "partial_quick_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &partial_quick_sort;
+#endif
+
+#elif STD_PARTIAL_SORT
+	#include "sort/top_k.cpp"
+	#define SELECT_RANK
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &std_partial_sort;
+	char const *ALGORITHM_NAME = "std_partial_sort";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &std_partial_sort;
+#endif
+
+#elif SORT_TOP_K
+	#include "sort/top_k.cpp"
+	#define SELECT_RANK
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &sort_top_k;
+	char const *ALGORITHM_NAME = "sort_top_k";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &sort_top_k;
+#endif
+
+#elif GOTO_MERGE_KERNEL
+	#include "sort/merge_kernel.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &goto_merge_kernel;
+	char const *ALGORITHM_NAME = "goto_merge_kernel";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &goto_merge_kernel;
+#endif
+
+#elif BRANCHLESS_MERGE_KERNEL
+	#include "sort/merge_kernel.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &branchless_merge_kernel;
+	char const *ALGORITHM_NAME = "branchless_merge_kernel";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &branchless_merge_kernel;
+#endif
+
+#elif SIMD_MERGE_KERNEL
+	#include "sort/merge_kernel.cpp"
+	typedef array_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &simd_merge_kernel;
+	char const *ALGORITHM_NAME = "simd_merge_kernel";
+#ifdef CACHE_TRACE
+	constexpr void(*traced_algorithm)(traced_array_type &) = &simd_merge_kernel;
+#endif
+
+#elif MSD_RADIX_SORT
+	#include "sort/string_sort.cpp"
+	#define STRING_DATA
+	typedef string_array_type data_type;
+	constexpr void(*algorithm)(data_type &) = &msd_radix_sort;
+	char const *ALGORITHM_NAME = "msd_radix_sort";
+
+#elif MULTIKEY_QUICK_SORT
+	#include "sort/string_sort.cpp"
+	#define STRING_DATA
+	typedef string_array_type data_type;
+	constexpr void(*algorithm)(data_type &) = &multikey_quick_sort;
+	char const *ALGORITHM_NAME = "multikey_quick_sort";
+
+#elif LCP_MERGE_SORT
+	#include "sort/string_sort.cpp"
+	#define STRING_DATA
+	typedef string_array_type data_type;
+	constexpr void(*algorithm)(data_type &) = &lcp_merge_sort;
+	char const *ALGORITHM_NAME = "lcp_merge_sort";
+
+#elif STRING_STD_SORT
+	// comparison sorts on strings, references for string sorts
+	#include "sort/std_sort.cpp"
+	#include "structures/string_array.cpp"
+	#define STRING_DATA
+	typedef string_array_type data_type;
+	constexpr void(*algorithm)(data_type &) = &std_sort;
+	char const *ALGORITHM_NAME = "string_std_sort";
+
+#elif STRING_PDQ_SORT
+	#include "sort/pdq_sort.cpp"
+	#include "structures/string_array.cpp"
+	#define STRING_DATA
+	typedef string_array_type data_type;
+	constexpr void(*algorithm)(data_type &) = &pdq_sort;
+	char const *ALGORITHM_NAME = "string_pdq_sort";
+
+#elif LIST_INSERTION_SORT
+	#include "sort/list_insertion_sort.cpp"
+	#define LIST_DATA
+	typedef list_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &list_insertion_sort;
+	char const *ALGORITHM_NAME = "list_insertion_sort";
+
+#elif LIST_MERGE_SORT
+	#include "sort/list_merge_sort.cpp"
+	#define LIST_DATA
+	typedef list_type<ELEMENT_TYPE> data_type;
+	constexpr void(*algorithm)(data_type &) = &list_merge_sort;
+	char const *ALGORITHM_NAME = "list_merge_sort";
 
 #else
 	static_assert(false);
 
 #endif
 
+#if defined(CACHE_TRACE) && defined(LIST_DATA)
+	#error "cache trace copies input into an array, lists are not supported"
+#endif
+
+#ifdef STRING_DATA
+	#if defined(CACHE_TRACE)
+		#error "cache trace has no traced strings"
+	#endif
+	#include "throughput_trace.cpp"
+#endif
+
+#ifdef PARALLEL_SORT
+	#if defined(CACHE_TRACE)
+		#error "cache trace simulates one thread, parallel sorts are not supported"
+	#endif
+	#include "speedup_trace.cpp"
+#endif
+
 
 
 
@@ -41,6 +476,19 @@ using namespace std;
 
 char const *DEFAULT_OUTPUT_FILE_NAME = "chart.chart";
 
+// build variant, set by variants.sh
+#ifndef BUILD_VARIANT
+	#define BUILD_VARIANT "default"
+#endif
+#ifndef BUILD_FLAGS
+	#define BUILD_FLAGS ""
+#endif
+
+#ifdef CLEVER_PROFILE
+	// the only run recorded by profiler zones: N and repetition
+	size_t profilen = 0, profilerepeat = 0;
+#endif
+
 
 /*
  * Algorithm:
@@ -53,8 +501,7 @@ char const *DEFAULT_OUTPUT_FILE_NAME = "chart.chart";
  */
 template<typename Ostream, typename Algorithm, typename DataType>
 void alghorithm_test(
-	Ostream &os, Algorithm alg,
-	DataType data = DataType(),
+	Ostream &os, Algorithm alg, DataType &data,
 	size_t maxn = 1000u, size_t repeatcount = 1000u
 )
 {
@@ -80,11 +527,23 @@ void alghorithm_test(
 			watch.reset();
 			data.update();
 
+#ifdef CLEVER_PROFILE
+			bool const profiled =
+				data.getN() == profilen && i == profilerepeat;
+			if(profiled)
+				clever::Profiler::start();
+#endif
+
 			// execute algorithm
 			watch.start();
 			alg(data);
 			watch.stop();
 
+#ifdef CLEVER_PROFILE
+			if(profiled)
+				clever::Profiler::stop();
+#endif
+
 			// writing
 			durs[i] = duration_cast<
 				duration_type
@@ -110,7 +569,29 @@ void alghorithm_test(
 
 		fbuf = (float)result.count();
 		os.write( (char const *)&fbuf, sizeof fbuf );
-		
+
+#ifdef STRING_DATA
+		// elements and characters per second of the same runs
+		throughput_trace.measure(data, repeatcount, result.count());
+#endif
+
+#ifdef CACHE_TRACE
+		// simulate caches on a fresh input, out of timed region
+		data.update();
+		cache_trace.measure(data, traced_algorithm);
+#endif
+
+#ifdef MEMORY_TRACE
+		// peak heap of one more run, out of timed region
+		data.update();
+		memory_trace.measure(data, alg);
+#endif
+
+#ifdef PARALLEL_SORT
+		// single-threaded baseline on inputs of the same N
+		speedup_trace.measure(data, baseline_algorithm, repeatcount, result.count());
+#endif
+
 
 		// to be continue...
 		data.next();
@@ -132,18 +613,309 @@ void alghorithm_test(
 
 
 
+// input of a run from options, false (and message) on error
+bool configure(
+	data_type &data, Options const &options,
+	std::string const &distribution, size_t maxn
+)
+{
+	if(!data.distribution.parse(distribution)) {
+		cerr << "unknown distribution '" << distribution << "'" << endl;
+		return false;
+	}
+	if(maxn > data.distribution.maxSize()) {
+		cerr << "maxn is bigger than " << data.distribution.maxSize() <<
+			" keys of '" << data.distribution.getFile() << "'" << endl;
+		return false;
+	}
+
+#ifdef LIST_DATA
+	// memory of list nodes: --layout=name, see linked_list.cpp
+	std::string const layout = options.get("layout", "sequential");
+	if(!data.layout.parse(layout)) {
+		cerr << "unknown layout '" << layout << "'" << endl;
+		return false;
+	}
+#endif
+
+#ifdef STRING_DATA
+	// set of strings: --strings=name[:parameter], see string_array.cpp
+	std::string const strings = options.get("strings", "random");
+	if(!data.shape.parse(strings)) {
+		cerr << "unknown strings '" << strings << "'" << endl;
+		return false;
+	}
+#endif
+
+	// --seed=S repeats inputs of an earlier run, see its .info
+	if(options.has("seed"))
+		data.reseed(options.get("seed", 0ul));
+
+	return true;
+}
+
+
+
+// maxn keys of the distribution as a key dump, false (and message) on error
+bool dump_keys(data_type &data, std::string const &filename, size_t maxn)
+{
+	std::vector<int64_t> keys(maxn);
+	clever::Xoshiro256 rng(data.seed);
+	data.distribution.fill(keys.data(), maxn, rng);
+	if(!KeyDump::write(filename, keys.data(), maxn)) {
+		cerr << "can't write key dump '" << filename << "'" << endl;
+		return false;
+	}
+	return true;
+}
+
+
+
+/*
+ * Two-dimensional sweep: the whole schedule of N for every value
+ * of distribution parameter, or of k in selection builds (the same
+ * input for every k). Matrix file, all numbers are floats:
+ *
+ *         columns, rows
+ *         x[columns]              - N
+ *         y[rows]                 - values of the parameter or k
+ *         time[rows][columns]     - microseconds, as in chart files
+ *
+ * chart_printer shows it as a heatmap.
+ */
+template<typename Ostream, typename Algorithm>
+bool grid_test(
+	Ostream &os, Algorithm alg, data_type const &data,
+	Options const &options, std::vector<std::string> const &grid,
+	size_t maxn, size_t repeatcount
+)
+{
+	std::vector<float> xs, ys, times;
+	for(auto const &value : grid) {
+		// every row starts from N = 1 with the same seed
+		data_type row;
+#ifdef SELECT_RANK
+		std::string const distribution = options.get("distribution", "random");
+		if(!configure(row, options, distribution, maxn))
+			return false;
+		if(!selection_settings().parse(value))
+			return false;
+		row.reseed(data.seed);
+		ys.push_back(selection_settings().k);
+#else
+		std::string const distribution =
+			data.distribution.getName() + ":" + value;
+		if(!configure(row, options, distribution, maxn))
+			return false;
+		row.reseed(data.seed);
+		ys.push_back(row.distribution.getParam());
+#endif
+
+		std::stringstream chart;
+		alghorithm_test(chart, alg, row, maxn, repeatcount);
+
+		float point[2];
+		while(chart.read((char *)point, sizeof point)) {
+			if(ys.size() == 1)
+				xs.push_back(point[0]);
+			times.push_back(point[1]);
+		}
+	}
+
+	float const size[2] = { float(xs.size()), float(ys.size()) };
+	os.write((char const *)size, sizeof size);
+	os.write((char const *)xs.data(), xs.size() * sizeof(float));
+	os.write((char const *)ys.data(), ys.size() * sizeof(float));
+	os.write((char const *)times.data(), times.size() * sizeof(float));
+	return bool(os);
+}
+
+
+
+
 
 // main
 int main( int argc, char *argv[] )
 {
-	char const *outfilename;
+	Options options(argc, argv);
+	std::string const outfilename =
+		options.positional(0, DEFAULT_OUTPUT_FILE_NAME);
+
+	// schedule: N goes 1..maxn, every N is measured repeat times
+	size_t const maxn = options.get("maxn", 4096ul);
+	size_t const repeatcount = options.get("repeat", 50ul);
+	if(maxn == 0 || repeatcount < 3) {
+		cerr << "invalid schedule: maxn >= 1, repeat >= 3" << endl;
+		return EXIT_FAILURE;
+	}
 
+	// input: --distribution=name[:parameter], see distribution.cpp
+	data_type data;
+	std::string const distribution = options.get("distribution", "random");
+	if(!configure(data, options, distribution, maxn))
+		return EXIT_FAILURE;
+
+	// --dump=file only records maxn keys of the input (same --seed,
+	// same keys), --distribution=replay:file measures on them
+	if(options.has("dump"))
+		return dump_keys(data, options.get("dump"), maxn) ? 0 : EXIT_FAILURE;
+
+#ifdef SELECT_RANK
+	// rank: --k=count or --k=fraction of N with point, see select.cpp
+	if(!selection_settings().parse(options.get("k", "0.5"))) {
+		cerr << "invalid k: count or fraction 0.0..1.0" << endl;
+		return EXIT_FAILURE;
+	}
+#endif
 
-	// set output file name
-	if(argc < 2)
-		outfilename = DEFAULT_OUTPUT_FILE_NAME;
-	else
-		outfilename = argv[1];
+	// second dimension: --grid=v1,v2,... values of distribution parameter,
+	// values of k in selection builds
+	std::vector<std::string> grid;
+	if(options.has("grid")) {
+		std::istringstream is(options.get("grid"));
+		for(std::string v; std::getline(is, v, ',');)
+			grid.push_back(v);
+
+#ifdef SELECT_RANK
+		if(grid.empty()) {
+			cerr << "grid needs values of k" << endl;
+			return EXIT_FAILURE;
+		}
+		for(auto const &v : grid) {
+			if(!SelectionSettings().parse(v)) {
+				cerr << "invalid grid value '" << v << "'" << endl;
+				return EXIT_FAILURE;
+			}
+		}
+#else
+		if(grid.empty() || !data.distribution.hasParam()) {
+			cerr << "grid needs values and a distribution with parameter" << endl;
+			return EXIT_FAILURE;
+		}
+		for(auto const &v : grid) {
+			if(!Distribution().parse(data.distribution.getName() + ":" + v)) {
+				cerr << "invalid grid value '" << v << "'" << endl;
+				return EXIT_FAILURE;
+			}
+		}
+#endif
+#if defined(CACHE_TRACE) || defined(MEMORY_TRACE) || defined(CLEVER_PROFILE) || defined(PARALLEL_SORT)
+		cerr << "grid is measured by plain timing builds only" << endl;
+		return EXIT_FAILURE;
+#endif
+	}
+
+#ifdef CACHE_TRACE
+	// cache hierarchy: --cache=file or default
+	{
+		clever::CacheSimulator sim = clever::CacheSimulator::makeDefault();
+		if(options.has("cache")) {
+			ifstream fin(options.get("cache"));
+			if(!fin) {
+				cerr << "can't open file '" << options.get("cache") << "'" << endl;
+				return EXIT_FAILURE;
+			}
+			if(!clever::CacheSimulator::read(fin, sim)) {
+				cerr << "invalid cache description '" <<
+					options.get("cache") << "'" << endl;
+				return EXIT_FAILURE;
+			}
+		}
+
+		cache_trace.open(outfilename, sim);
+		if(!cache_trace.good()) {
+			cerr << "can't open cache trace files" << endl;
+			return EXIT_FAILURE;
+		}
+	}
+#endif
+
+
+#ifdef STRING_DATA
+	throughput_trace.open(outfilename);
+	if(!throughput_trace.good()) {
+		cerr << "can't open throughput trace files" << endl;
+		return EXIT_FAILURE;
+	}
+#endif
+
+
+#ifdef MEMORY_TRACE
+	memory_trace.open(outfilename);
+	if(!memory_trace.good()) {
+		cerr << "can't open memory trace file" << endl;
+		return EXIT_FAILURE;
+	}
+#endif
+
+
+#ifdef PARALLEL_SORT
+	// --threads=T (0 is one per core), --cutoff=N elements sorted by one thread
+	parallel_sort_settings().threads = options.get("threads", 0ul);
+	parallel_sort_settings().cutoff = options.get("cutoff", 8192ul);
+	if(parallel_sort_settings().cutoff == 0) {
+		cerr << "invalid cutoff: cutoff >= 1" << endl;
+		return EXIT_FAILURE;
+	}
+
+	speedup_trace.open(outfilename, parallel_sort_pool().size());
+	if(!speedup_trace.good()) {
+		cerr << "can't open speedup trace files" << endl;
+		return EXIT_FAILURE;
+	}
+#endif
+
+
+#ifdef CLEVER_PROFILE
+	// profiled run: --profile-n=N --profile-repeat=R, default is the last one
+	std::string const profilefilename = options.get("profile", outfilename + ".json");
+	profilen = options.get("profile-n", (unsigned long)maxn);
+	profilerepeat = options.get("profile-repeat", (unsigned long)repeatcount-1);
+	if(profilen == 0 || profilen > maxn || profilerepeat >= repeatcount) {
+		cerr << "profiled run is out of schedule" << endl;
+		return EXIT_FAILURE;
+	}
+#endif
+
+
+	// description of run
+	{
+		RunInfo info;
+		info.set("algorithm", ALGORITHM_NAME)
+			.set("maxn", maxn)
+			.set("repeat", repeatcount)
+			.set("element", ElementTraits<data_type::value_type>::name())
+			.set("element_size", sizeof(data_type::value_type))
+			.set("distribution", data.distribution.getName())
+			.set("seed", data.seed)
+			.set("variant", BUILD_VARIANT)
+			.set("flags", BUILD_FLAGS)
+			.set("compiler", __VERSION__);
+		if(data.distribution.hasParam())
+			info.set("distribution_param", data.distribution.getParam());
+		if(data.distribution.hasFile())
+			info.set("distribution_file", data.distribution.getFile());
+#ifdef LIST_DATA
+		info.set("layout", data.layout.getName());
+#endif
+#ifdef STRING_DATA
+		info.set("strings", data.shape.getName())
+			.set("strings_param", data.shape.getParam());
+#endif
+		if(options.has("grid"))
+			info.set("grid", options.get("grid"));
+#ifdef SELECT_RANK
+		info.set("k", options.get("k", "0.5"));
+#endif
+#ifdef PARALLEL_SORT
+		info.set("threads", parallel_sort_pool().size())
+			.set("cutoff", parallel_sort_settings().cutoff);
+#endif
+		if(!info.write(outfilename + ".info")) {
+			cerr << "can't open file '" << outfilename << ".info'" << endl;
+			return EXIT_FAILURE;
+		}
+	}
 
 
 	// test algorthim
@@ -154,13 +926,34 @@ int main( int argc, char *argv[] )
 			return EXIT_FAILURE;
 		}
 
-		alghorithm_test(
-			fout, algorithm, data_type(),
-			4096u, 50u
-		);
+		if(grid.empty()) {
+			alghorithm_test(
+				fout, algorithm, data,
+				maxn, repeatcount
+			);
+		}
+		else if(!grid_test(
+			fout, algorithm, data, options, grid,
+			maxn, repeatcount
+		)) {
+			return EXIT_FAILURE;
+		}
 	}
 
 
+#ifdef CLEVER_PROFILE
+	// chrome trace of the profiled run
+	{
+		ofstream fout(profilefilename);
+		if(!fout) {
+			cerr << "can't open file '" << profilefilename << "'" << endl;
+			return EXIT_FAILURE;
+		}
+		clever::Profiler::writeChromeTrace(fout);
+	}
+#endif
+
+
 	// it's all
 	return 0;
 }
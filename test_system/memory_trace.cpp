@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+
+
+
+
+
+/*
+ * Memory trace mode (-DMEMORY_TRACE).
+ *
+ * Global operator new/delete count bytes on the heap. After every
+ * measured N the algorithm runs once more on a fresh input in a new
+ * thread, so per-thread scratch buffers are allocated inside the run,
+ * and the peak of heap bytes above the start of the run is written
+ * to "<output>.memory.chart" next to the time chart.
+ *
+ * Buffers kept by pool threads between runs are counted only when
+ * they grow. Every form of new is replaced (nothrow, aligned), so
+ * get_temporary_buffer and over-aligned types are counted too.
+ */
+namespace memory_trace_detail
+{
+	// size header keeps max_align_t alignment of the block,
+	// aligned blocks get a header of their alignment
+	constexpr size_t const HEADER = alignof(std::max_align_t);
+
+	inline std::atomic<size_t> live{0};
+	inline std::atomic<size_t> peak{0};
+
+	// nullptr on failure
+	inline void *allocate(size_t size, size_t align = HEADER)
+	{
+		size_t const header = std::max(HEADER, align);
+		void *const p = align <= HEADER ?
+			std::malloc(size + header) :
+			std::aligned_alloc(align, (size + header + align - 1) / align * align);
+		if(!p)
+			return nullptr;
+		*(size_t *)p = size;
+
+		size_t const now = live.fetch_add(size, std::memory_order_relaxed) + size;
+		size_t old = peak.load(std::memory_order_relaxed);
+		while(now > old && !peak.compare_exchange_weak(old, now, std::memory_order_relaxed));
+		return (char *)p + header;
+	}
+
+	inline void *allocate_or_throw(size_t size, size_t align = HEADER)
+	{
+		void *const p = allocate(size, align);
+		if(!p)
+			throw std::bad_alloc();
+		return p;
+	}
+
+	inline void deallocate(void *p, size_t align = HEADER)
+	{
+		if(!p)
+			return;
+		void *const block = (char *)p - std::max(HEADER, align);
+		live.fetch_sub(*(size_t *)block, std::memory_order_relaxed);
+		std::free(block);
+		return;
+	}
+}
+
+void *operator new(size_t size)
+{
+	return memory_trace_detail::allocate_or_throw(size);
+}
+
+void *operator new[](size_t size)
+{
+	return memory_trace_detail::allocate_or_throw(size);
+}
+
+void *operator new(size_t size, std::nothrow_t const &) noexcept
+{
+	return memory_trace_detail::allocate(size);
+}
+
+void *operator new[](size_t size, std::nothrow_t const &) noexcept
+{
+	return memory_trace_detail::allocate(size);
+}
+
+void *operator new(size_t size, std::align_val_t align)
+{
+	return memory_trace_detail::allocate_or_throw(size, size_t(align));
+}
+
+void *operator new[](size_t size, std::align_val_t align)
+{
+	return memory_trace_detail::allocate_or_throw(size, size_t(align));
+}
+
+void *operator new(size_t size, std::align_val_t align, std::nothrow_t const &) noexcept
+{
+	return memory_trace_detail::allocate(size, size_t(align));
+}
+
+void *operator new[](size_t size, std::align_val_t align, std::nothrow_t const &) noexcept
+{
+	return memory_trace_detail::allocate(size, size_t(align));
+}
+
+void operator delete(void *p) noexcept
+{
+	memory_trace_detail::deallocate(p);
+	return;
+}
+
+void operator delete[](void *p) noexcept
+{
+	memory_trace_detail::deallocate(p);
+	return;
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	memory_trace_detail::deallocate(p);
+	return;
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+	memory_trace_detail::deallocate(p);
+	return;
+}
+
+void operator delete(void *p, std::nothrow_t const &) noexcept
+{
+	memory_trace_detail::deallocate(p);
+	return;
+}
+
+void operator delete[](void *p, std::nothrow_t const &) noexcept
+{
+	memory_trace_detail::deallocate(p);
+	return;
+}
+
+void operator delete(void *p, std::align_val_t align) noexcept
+{
+	memory_trace_detail::deallocate(p, size_t(align));
+	return;
+}
+
+void operator delete[](void *p, std::align_val_t align) noexcept
+{
+	memory_trace_detail::deallocate(p, size_t(align));
+	return;
+}
+
+void operator delete(void *p, size_t, std::align_val_t align) noexcept
+{
+	memory_trace_detail::deallocate(p, size_t(align));
+	return;
+}
+
+void operator delete[](void *p, size_t, std::align_val_t align) noexcept
+{
+	memory_trace_detail::deallocate(p, size_t(align));
+	return;
+}
+
+void operator delete(void *p, std::align_val_t align, std::nothrow_t const &) noexcept
+{
+	memory_trace_detail::deallocate(p, size_t(align));
+	return;
+}
+
+void operator delete[](void *p, std::align_val_t align, std::nothrow_t const &) noexcept
+{
+	memory_trace_detail::deallocate(p, size_t(align));
+	return;
+}
+
+
+
+class MemoryTrace
+{
+public:
+	void open(std::string const &outfilename)
+	{
+		file_.reset(new std::ofstream(
+			outfilename + ".memory.chart", std::ofstream::binary
+		));
+		return;
+	}
+
+	bool good() const
+	{
+		return file_ && *file_;
+	}
+
+
+	template<typename DataType, typename Algorithm>
+	void measure(DataType &data, Algorithm alg)
+	{
+		using namespace memory_trace_detail;
+
+		size_t extra = 0;
+		std::thread([&] {
+			size_t const start = live.load();
+			peak.store(start);
+			alg(data);
+			extra = peak.load() - start;
+		}).join();
+
+		float const x = (float)data.getN();
+		float const y = (float)extra;
+		file_->write( (char const *)&x, sizeof x );
+		file_->write( (char const *)&y, sizeof y );
+		return;
+	}
+
+private:
+	std::unique_ptr<std::ofstream> file_;
+
+};
+
+
+MemoryTrace memory_trace;
+
+
+
+
+
+// end
@@ -0,0 +1,92 @@
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+
+
+
+
+/*
+ * Command line of the harness:
+ *         program [positional...] [--name=value...] [--flag...]
+ *
+ * Positional arguments keep their old meaning (output file first),
+ * named ones are looked up by get().
+ */
+class Options
+{
+public:
+	Options(int argc, char *argv[])
+	{
+		for(int i = 1; i < argc; ++i) {
+			std::string arg = argv[i];
+			if(arg.compare(0, 2, "--") != 0) {
+				positional_.push_back(arg);
+				continue;
+			}
+
+			size_t eq = arg.find('=');
+			if(eq == std::string::npos)
+				named_[arg.substr(2)] = "";
+			else
+				named_[arg.substr(2, eq-2)] = arg.substr(eq+1);
+		}
+		return;
+	}
+
+
+
+	bool has(std::string const &name) const
+	{
+		return named_.count(name) != 0;
+	}
+
+	std::string get(
+		std::string const &name,
+		std::string const &defvalue = ""
+	) const
+	{
+		auto it = named_.find(name);
+		return it == named_.end() ? defvalue : it->second;
+	}
+
+	unsigned long get(std::string const &name, unsigned long defvalue) const
+	{
+		auto it = named_.find(name);
+		return it == named_.end() || it->second.empty() ?
+			defvalue : std::strtoul(it->second.c_str(), nullptr, 0);
+	}
+
+	double get(std::string const &name, double defvalue) const
+	{
+		auto it = named_.find(name);
+		return it == named_.end() || it->second.empty() ?
+			defvalue : std::strtod(it->second.c_str(), nullptr);
+	}
+
+
+
+	std::string positional(
+		size_t i, std::string const &defvalue = ""
+	) const
+	{
+		return i < positional_.size() ? positional_[i] : defvalue;
+	}
+
+	size_t positionalCount() const
+	{
+		return positional_.size();
+	}
+
+private:
+	std::vector<std::string> positional_;
+	std::map<std::string, std::string> named_;
+
+};
+
+
+
+
+
+// end
@@ -0,0 +1,318 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "run_info.cpp"
+
+
+
+
+
+/*
+ * Append-only local store of measured runs.
+ *
+ *         <root>/runs/<id>.chart - immutable copy of a chart file
+ *         <root>/runs/<id>.info  - its run description, if any
+ *         <root>/index           - fixed-size IndexRecord per run
+ *
+ * Queries read only the index, run files are opened just for
+ * the matching records.
+ */
+struct IndexRecord
+{
+	uint64_t id;
+	int64_t date;           // unix time of the run
+	uint64_t host;          // host fingerprint, see host_fingerprint()
+	char algorithm[32];
+	char distribution[32];
+	char variant[16];       // build variant, see variants.sh
+	char element[16];       // element type, see elements.cpp
+	char revision[16];      // short git revision
+};
+
+
+
+// filter for queries, empty fields match anything
+struct RunFilter
+{
+	std::string algorithm;
+	std::string distribution;
+	std::string variant;
+	std::string element;
+	uint64_t host = 0;
+	std::string revision;
+	int64_t since = 0;
+	int64_t until = 0;
+
+	bool match(IndexRecord const &r) const
+	{
+		return
+			(algorithm.empty() || algorithm == r.algorithm) &&
+			(distribution.empty() || distribution == r.distribution) &&
+			(variant.empty() || variant == r.variant) &&
+			(element.empty() || element == r.element) &&
+			(host == 0 || host == r.host) &&
+			(revision.empty() ||
+				std::strncmp(r.revision, revision.c_str(), revision.size()) == 0) &&
+			(since == 0 || r.date >= since) &&
+			(until == 0 || r.date < until);
+	}
+};
+
+
+
+
+
+// host and revision
+inline uint64_t fnv1a(std::string const &s, uint64_t h = 14695981039346656037ull)
+{
+	for(unsigned char ch : s) {
+		h ^= ch;
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+// hostname, cpu model and number of cpus
+inline uint64_t host_fingerprint()
+{
+	char hostname[256] = {0};
+	gethostname(hostname, sizeof hostname - 1);
+
+	std::string model;
+	std::ifstream cpuinfo("/proc/cpuinfo");
+	std::string line;
+	while(std::getline(cpuinfo, line)) {
+		if(line.compare(0, 10, "model name") == 0) {
+			model = line;
+			break;
+		}
+	}
+
+	return fnv1a(
+		std::string(hostname) + '\n' + model + '\n' +
+		std::to_string(sysconf(_SC_NPROCESSORS_ONLN))
+	);
+}
+
+inline std::string git_revision()
+{
+	std::string rev;
+	if(FILE *p = popen("git rev-parse --short=12 HEAD 2>/dev/null", "r")) {
+		char buf[64];
+		if(fgets(buf, sizeof buf, p))
+			rev = buf;
+		pclose(p);
+	}
+	while(!rev.empty() && (rev.back() == '\n' || rev.back() == ' '))
+		rev.pop_back();
+	return rev.empty() ? "unknown" : rev;
+}
+
+// YYYY-MM-DD -> unix time, 0 on error
+inline int64_t parse_date(std::string const &s)
+{
+	tm t;
+	std::memset(&t, 0, sizeof t);
+	char const *end = strptime(s.c_str(), "%Y-%m-%d", &t);
+	if(!end || *end)
+		return 0;
+	return timegm(&t);
+}
+
+
+
+
+
+class ResultStore
+{
+public:
+	ResultStore(std::string const &root): root_(root) {}
+
+	// create directories, false on failure
+	bool open()
+	{
+		mkdir(root_.c_str(), 0755);
+		mkdir((root_ + "/runs").c_str(), 0755);
+
+		struct stat st;
+		return stat((root_ + "/runs").c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+	}
+
+	std::string runFileName(uint64_t id) const
+	{
+		return root_ + "/runs/" + std::to_string(id) + ".chart";
+	}
+	std::string infoFileName(uint64_t id) const
+	{
+		return root_ + "/runs/" + std::to_string(id) + ".info";
+	}
+
+
+
+	/*
+	 * Copies chart file (and "<chart file>.info") into the store
+	 * and appends index record. Empty variant is taken from the info,
+	 * so is the element type. Empty distribution is taken from the info
+	 * too, as name:param; string runs are keyed by their shape instead
+	 * ("prefix:64"), so shapes of the same sort don't mix.
+	 * Returns new id, 0 on failure or if a name doesn't fit
+	 * its IndexRecord field.
+	 */
+	uint64_t add(
+		std::string const &chartfile,
+		std::string const &algorithm,
+		std::string distribution = "",
+		std::string variant = "",
+		std::string const &revision = git_revision(),
+		int64_t date = time(nullptr),
+		uint64_t host = host_fingerprint()
+	)
+	{
+		int fd = ::open(
+			(root_ + "/index").c_str(),
+			O_RDWR | O_CREAT | O_APPEND, 0644
+		);
+		if(fd < 0)
+			return 0;
+		flock(fd, LOCK_EX);
+
+		RunInfo info;
+		bool const hasinfo = info.read(chartfile + ".info");
+		if(variant.empty())
+			variant = info.get("variant", "default");
+		if(distribution.empty())
+			distribution = info_distribution_(info);
+
+		// next id is the number of records plus one
+		struct stat st;
+		fstat(fd, &st);
+		IndexRecord r;
+		std::memset(&r, 0, sizeof r);
+		r.id = st.st_size / sizeof(IndexRecord) + 1;
+		r.date = date;
+		r.host = host;
+		// cut names would put different runs into one series
+		if(
+			!set_field_(r.algorithm, algorithm) ||
+			!set_field_(r.distribution, distribution) ||
+			!set_field_(r.variant, variant) ||
+			!set_field_(r.element, info.get("element", "int32")) ||
+			!set_field_(r.revision, revision)
+		) {
+			flock(fd, LOCK_UN);
+			close(fd);
+			return 0;
+		}
+
+		bool ok = copy_file_(chartfile, runFileName(r.id));
+		if(ok && hasinfo)
+			ok = copy_file_(chartfile + ".info", infoFileName(r.id));
+		if(ok) {
+			chmod(runFileName(r.id).c_str(), 0444);
+			if(hasinfo)
+				chmod(infoFileName(r.id).c_str(), 0444);
+			ok = ::write(fd, &r, sizeof r) == sizeof r;
+		}
+		if(!ok) {
+			unlink(runFileName(r.id).c_str());
+			unlink(infoFileName(r.id).c_str());
+		}
+
+		flock(fd, LOCK_UN);
+		close(fd);
+		return ok ? r.id : 0;
+	}
+
+
+
+	// all records matching filter, in order of adding
+	std::vector<IndexRecord> query(RunFilter const &filter) const
+	{
+		std::vector<IndexRecord> result;
+		std::ifstream fin(root_ + "/index", std::ifstream::binary);
+		if(!fin)
+			return result;
+
+		// read index by big blocks
+		constexpr size_t const BLOCK = 4096;
+		std::vector<IndexRecord> block(BLOCK);
+		while(fin) {
+			fin.read((char *)block.data(), BLOCK * sizeof(IndexRecord));
+			size_t const n = fin.gcount() / sizeof(IndexRecord);
+			for(size_t i = 0; i < n; ++i)
+				if(filter.match(block[i]))
+					result.push_back(block[i]);
+		}
+		return result;
+	}
+
+	// points of stored chart
+	std::vector<std::pair<float, float>> readChart(uint64_t id) const
+	{
+		std::vector<std::pair<float, float>> chart;
+		std::ifstream fin(runFileName(id), std::ifstream::binary);
+		std::pair<float, float> point;
+		while(
+			fin.read( (char *)&point.first, sizeof point.first ) &&
+			fin.read( (char *)&point.second, sizeof point.second )
+		) {
+			chart.push_back(point);
+		}
+		return chart;
+	}
+
+private:
+	static std::string info_distribution_(RunInfo const &info)
+	{
+		std::string const strings = info.get("strings");
+		if(!strings.empty())
+			return strings + ":" + info.get("strings_param");
+		std::string const name = info.get("distribution", "random");
+		std::string const param = info.get("distribution_param");
+		return param.empty() ? name : name + ":" + param;
+	}
+
+	// false if s with terminating zero doesn't fit
+	template<size_t N>
+	static bool set_field_(char (&field)[N], std::string const &s)
+	{
+		if(s.size() >= N)
+			return false;
+		std::memcpy(field, s.c_str(), s.size() + 1);
+		return true;
+	}
+
+	static bool copy_file_(std::string const &from, std::string const &to)
+	{
+		std::ifstream fin(from, std::ifstream::binary);
+		std::ofstream fout(to, std::ofstream::binary | std::ofstream::trunc);
+		if(!fin || !fout)
+			return false;
+		// << sets failbit when it copies nothing, empty file is fine
+		if(fin.peek() != std::ifstream::traits_type::eof())
+			fout << fin.rdbuf();
+		return bool(fout) && !fin.bad();
+	}
+
+
+
+	std::string root_;
+
+};
+
+
+
+
+
+// end
@@ -0,0 +1,89 @@
+#ifndef RUN_INFO_CPP
+#define RUN_INFO_CPP
+
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+
+
+
+
+/*
+ * Description of a run, written by the harness next to the chart
+ * as "<output>.info" in libconfig syntax:
+ *
+ *         algorithm = "merge_sort";
+ *         variant = "O2";
+ *         ...
+ *
+ * The result store keeps it together with the chart.
+ */
+class RunInfo
+{
+public:
+	template<typename T>
+	RunInfo &set(std::string const &key, T const &value)
+	{
+		std::ostringstream os;
+		os << value;
+		values_[key] = os.str();
+		return *this;
+	}
+
+	std::string get(std::string const &key, std::string const &defvalue = "") const
+	{
+		auto it = values_.find(key);
+		return it == values_.end() ? defvalue : it->second;
+	}
+
+
+	bool write(std::string const &filename) const
+	{
+		std::ofstream fout(filename);
+		for(auto const &v : values_) {
+			fout << v.first << " = \"";
+			for(char ch : v.second) {
+				if(ch == '"' || ch == '\\')
+					fout << '\\';
+				fout << ch;
+			}
+			fout << "\";\n";
+		}
+		return bool(fout);
+	}
+
+	bool read(std::string const &filename)
+	{
+		std::ifstream fin(filename);
+		if(!fin)
+			return false;
+
+		std::string line;
+		while(std::getline(fin, line)) {
+			size_t const eq = line.find(" = \"");
+			if(eq == std::string::npos || line.size() < eq + 6)
+				continue;
+
+			std::string value;
+			for(size_t i = eq + 4; i + 2 < line.size(); ++i) {
+				if(line[i] == '\\')
+					++i;
+				value += line[i];
+			}
+			values_[line.substr(0, eq)] = value;
+		}
+		return true;
+	}
+
+private:
+	std::map<std::string, std::string> values_;
+
+};
+
+
+
+
+
+#endif
@@ -0,0 +1,767 @@
+#ifndef BLOCK_MERGE_SORT_CPP
+#define BLOCK_MERGE_SORT_CPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <clever/Profiler.hpp>
+
+#include "../structures/random_array.cpp"
+#include "compare.cpp"
+
+
+
+
+
+/*
+ * Stable block merge sort without an n-element buffer
+ * (GrailSort, Andrey Astrelin):
+ *
+ *         - up to sqrt(n) + n/sqrt(n) distinct keys are collected at the
+ *           array start by rotations: the first sqrt(n) of them serve
+ *           as internal merge buffer (merges swap elements through it,
+ *           nothing is lost), the rest tag blocks to keep merges stable
+ *         - runs are merged by blocks of sqrt(n): blocks of two runs
+ *           are sorted by their first elements (selection sort, ties
+ *           by tags), then neighbouring blocks from different runs are
+ *           merged locally through the buffer
+ *         - at the end keys and buffer are sorted by insertion and merged
+ *           into the rest by rotations
+ *         - without enough distinct keys there is no buffer: blocks get
+ *           smaller and local merges use rotations; with fewer than
+ *           4 keys the whole array is merged by rotations
+ *
+ * External cache (grail_cache_sort) replaces swaps through the
+ * internal buffer with copies while merging small runs and blocks.
+ * Generic versions grail_sort(first, last, comp, proj) and
+ * grail_cache_sort(first, last, comp, proj), see compare.cpp.
+ */
+constexpr ptrdiff_t const GRAIL_INSERTION = 16;
+
+
+
+template<typename T, typename Compare>
+inline int grail_compare(T const &a, T const &b, Compare less)
+{
+	return less(a, b) ? -1 : (less(b, a) ? 1 : 0);
+}
+
+template<typename Iter>
+inline void grail_swap_n(Iter a, Iter b, ptrdiff_t n)
+{
+	while(n--)
+		std::swap(*a++, *b++);
+	return;
+}
+
+// [a, a+l1) and [a+l1, a+l1+l2) swap places
+template<typename Iter>
+void grail_rotate(Iter a, ptrdiff_t l1, ptrdiff_t l2)
+{
+	while(l1 && l2)
+	{
+		if(l1 <= l2)
+		{
+			grail_swap_n(a, a + l1, l1);
+			a += l1;
+			l2 -= l1;
+		}
+		else
+		{
+			grail_swap_n(a + (l1 - l2), a + l1, l2);
+			l1 -= l2;
+		}
+	}
+	return;
+}
+
+// first position with element not less than key
+template<typename Iter, typename T, typename Compare>
+ptrdiff_t grail_search_left(Iter a, ptrdiff_t n, T const &key, Compare less)
+{
+	ptrdiff_t lo = -1, hi = n;
+	while(lo < hi - 1)
+	{
+		ptrdiff_t const mid = lo + ((hi - lo) >> 1);
+		if(!less(a[mid], key))
+			hi = mid;
+		else
+			lo = mid;
+	}
+	return hi;
+}
+
+// first position with element greater than key
+template<typename Iter, typename T, typename Compare>
+ptrdiff_t grail_search_right(Iter a, ptrdiff_t n, T const &key, Compare less)
+{
+	ptrdiff_t lo = -1, hi = n;
+	while(lo < hi - 1)
+	{
+		ptrdiff_t const mid = lo + ((hi - lo) >> 1);
+		if(less(key, a[mid]))
+			hi = mid;
+		else
+			lo = mid;
+	}
+	return hi;
+}
+
+template<typename Iter, typename Compare>
+void grail_insertion_sort(Iter a, ptrdiff_t n, Compare less)
+{
+	for(ptrdiff_t i = 1; i < n; ++i)
+		for(ptrdiff_t j = i - 1; j >= 0 && less(a[j+1], a[j]); --j)
+			std::swap(a[j], a[j+1]);
+	return;
+}
+
+
+
+// distinct keys to the array start, in sorted order; returns their number
+template<typename Iter, typename Compare>
+ptrdiff_t grail_find_keys(Iter a, ptrdiff_t n, ptrdiff_t wanted, Compare less)
+{
+	ptrdiff_t found = 1, first = 0;
+	for(ptrdiff_t u = 1; u < n && found < wanted; ++u)
+	{
+		ptrdiff_t const r = grail_search_left(a + first, found, a[u], less);
+		if(r == found || grail_compare(a[u], a[first + r], less) != 0)
+		{
+			// keys move to just before u, then u joins them
+			grail_rotate(a + first, found, u - (first + found));
+			first = u - found;
+			grail_rotate(a + (first + r), found - r, 1);
+			++found;
+		}
+	}
+	grail_rotate(a, first, found);
+	return found;
+}
+
+// stable merge of [a, a+l1) and [a+l1, a+l1+l2) by rotations
+template<typename Iter, typename Compare>
+void grail_merge_without_buffer(Iter a, ptrdiff_t l1, ptrdiff_t l2, Compare less)
+{
+	if(l1 < l2)
+	{
+		while(l1)
+		{
+			ptrdiff_t const h = grail_search_left(a + l1, l2, a[0], less);
+			if(h != 0)
+			{
+				grail_rotate(a, l1, h);
+				a += h;
+				l2 -= h;
+			}
+			if(l2 == 0)
+				break;
+			do
+			{
+				++a;
+				--l1;
+			}
+			while(l1 && !less(a[l1], a[0]));
+		}
+	}
+	else
+	{
+		while(l2)
+		{
+			ptrdiff_t const h = grail_search_right(a, l1, a[l1 + l2 - 1], less);
+			if(h != l1)
+			{
+				grail_rotate(a + h, l1 - h, l2);
+				l1 = h;
+			}
+			if(l1 == 0)
+				break;
+			do
+			{
+				--l2;
+			}
+			while(l2 && !less(a[l1 + l2 - 1], a[l1 - 1]));
+		}
+	}
+	return;
+}
+
+
+
+// a[m, 0) is buffer: [a, a+l1) + [a+l1, a+l1+l2) merged to a+m by swaps
+template<typename Iter, typename Compare>
+void grail_merge_left(Iter a, ptrdiff_t l1, ptrdiff_t l2, ptrdiff_t m, Compare less)
+{
+	ptrdiff_t p0 = 0, p1 = l1;
+	l2 += l1;
+	while(p1 < l2)
+	{
+		if(p0 == l1 || less(a[p1], a[p0]))
+			std::swap(a[m++], a[p1++]);
+		else
+			std::swap(a[m++], a[p0++]);
+	}
+	if(m != p0)
+		grail_swap_n(a + m, a + p0, l1 - p0);
+	return;
+}
+
+// buffer after the ranges: merged from the end
+template<typename Iter, typename Compare>
+void grail_merge_right(Iter a, ptrdiff_t l1, ptrdiff_t l2, ptrdiff_t m, Compare less)
+{
+	ptrdiff_t p0 = l1 + l2 + m - 1, p2 = l1 + l2 - 1, p1 = l1 - 1;
+	while(p1 >= 0)
+	{
+		if(p2 < l1 || less(a[p2], a[p1]))
+			std::swap(a[p0--], a[p1--]);
+		else
+			std::swap(a[p0--], a[p2--]);
+	}
+	if(p2 != p0)
+		while(p2 >= l1)
+			std::swap(a[p0--], a[p2--]);
+	return;
+}
+
+/*
+ * Merge of the rest of previous blocks [a, a+*restlen) of stream
+ * *resttype (0 - first run, 1 - second) with the next block of the
+ * other stream, through the buffer before a. Whatever is left over
+ * becomes the new rest.
+ */
+template<typename Iter, typename Compare>
+void grail_smart_merge_with_buffer(
+	Iter a, ptrdiff_t *restlen, int *resttype, ptrdiff_t l2, ptrdiff_t lkeys,
+	Compare less
+)
+{
+	ptrdiff_t p0 = -lkeys, p1 = 0, p2 = *restlen, q1 = p2, q2 = p2 + l2;
+	int const ftype = 1 - *resttype;
+	while(p1 < q1 && p2 < q2)
+	{
+		if(grail_compare(a[p1], a[p2], less) - ftype < 0)
+			std::swap(a[p0++], a[p1++]);
+		else
+			std::swap(a[p0++], a[p2++]);
+	}
+	if(p1 < q1)
+	{
+		*restlen = q1 - p1;
+		while(p1 < q1)
+			std::swap(a[--q1], a[--q2]);
+	}
+	else
+	{
+		*restlen = q2 - p2;
+		*resttype = ftype;
+	}
+	return;
+}
+
+template<typename Iter, typename Compare>
+void grail_smart_merge_without_buffer(
+	Iter a, ptrdiff_t *restlen, int *resttype, ptrdiff_t len2, Compare less
+)
+{
+	if(!len2)
+		return;
+	ptrdiff_t l1 = *restlen, l2 = len2;
+	int const ftype = 1 - *resttype;
+	if(l1 && grail_compare(a[l1 - 1], a[l1], less) - ftype >= 0)
+	{
+		while(l1)
+		{
+			ptrdiff_t const h = ftype ?
+				grail_search_left(a + l1, l2, a[0], less) :
+				grail_search_right(a + l1, l2, a[0], less);
+			if(h != 0)
+			{
+				grail_rotate(a, l1, h);
+				a += h;
+				l2 -= h;
+			}
+			if(l2 == 0)
+			{
+				*restlen = l1;
+				return;
+			}
+			do
+			{
+				++a;
+				--l1;
+			}
+			while(l1 && grail_compare(a[0], a[l1], less) - ftype < 0);
+		}
+	}
+	*restlen = l2;
+	*resttype = ftype;
+	return;
+}
+
+
+
+// the same merges with free space instead of buffer: copies, not swaps
+template<typename Iter, typename Compare>
+void grail_merge_left_cached(Iter a, ptrdiff_t l1, ptrdiff_t l2, ptrdiff_t m, Compare less)
+{
+	ptrdiff_t p0 = 0, p1 = l1;
+	l2 += l1;
+	while(p1 < l2)
+	{
+		if(p0 == l1 || less(a[p1], a[p0]))
+			a[m++] = a[p1++];
+		else
+			a[m++] = a[p0++];
+	}
+	if(m != p0)
+		while(p0 < l1)
+			a[m++] = a[p0++];
+	return;
+}
+
+template<typename Iter, typename Compare>
+void grail_smart_merge_cached(
+	Iter a, ptrdiff_t *restlen, int *resttype, ptrdiff_t l2, ptrdiff_t lkeys,
+	Compare less
+)
+{
+	ptrdiff_t p0 = -lkeys, p1 = 0, p2 = *restlen, q1 = p2, q2 = p2 + l2;
+	int const ftype = 1 - *resttype;
+	while(p1 < q1 && p2 < q2)
+	{
+		if(grail_compare(a[p1], a[p2], less) - ftype < 0)
+			a[p0++] = a[p1++];
+		else
+			a[p0++] = a[p2++];
+	}
+	if(p1 < q1)
+	{
+		*restlen = q1 - p1;
+		while(p1 < q1)
+			a[--q2] = a[--q1];
+	}
+	else
+	{
+		*restlen = q2 - p2;
+		*resttype = ftype;
+	}
+	return;
+}
+
+
+
+/*
+ * Local merges of nblock sorted blocks of lblock elements; keys tell
+ * the stream of every block (less than midkey - first run). nblock2
+ * blocks of the first run go after them, then llast elements of the
+ * last irregular block of the second run. Buffer is a[-lblock, 0)
+ * (free space if cached), result is shifted by lblock to the left.
+ */
+template<typename Iter, typename T, typename Compare>
+void grail_merge_buffers_left(
+	Iter keys, T const &midkey, Iter a, ptrdiff_t nblock, ptrdiff_t lblock,
+	bool havebuf, bool cached, ptrdiff_t nblock2, ptrdiff_t llast, Compare less
+)
+{
+	auto move_rest = [&](Iter to, Iter from, ptrdiff_t n) {
+		if(cached)
+			std::copy(from, from + n, to);
+		else if(havebuf)
+			grail_swap_n(to, from, n);
+		return;
+	};
+	auto merge_last = [&](Iter from, ptrdiff_t l1, ptrdiff_t l2) {
+		if(cached)
+			grail_merge_left_cached(from, l1, l2, -lblock, less);
+		else if(havebuf)
+			grail_merge_left(from, l1, l2, -lblock, less);
+		else
+			grail_merge_without_buffer(from, l1, l2, less);
+		return;
+	};
+
+	if(nblock == 0)
+	{
+		merge_last(a, nblock2 * lblock, llast);
+		return;
+	}
+
+	ptrdiff_t restlen = lblock;
+	int resttype = less(keys[0], midkey) ? 0 : 1;
+	ptrdiff_t pos = lblock;
+	for(ptrdiff_t i = 1; i < nblock; ++i, pos += lblock)
+	{
+		ptrdiff_t rest = pos - restlen;
+		int const nexttype = less(keys[i], midkey) ? 0 : 1;
+		if(nexttype == resttype)
+		{
+			move_rest(a + rest - lblock, a + rest, restlen);
+			restlen = lblock;
+		}
+		else if(cached)
+			grail_smart_merge_cached(a + rest, &restlen, &resttype, lblock, lblock, less);
+		else if(havebuf)
+			grail_smart_merge_with_buffer(a + rest, &restlen, &resttype, lblock, lblock, less);
+		else
+			grail_smart_merge_without_buffer(a + rest, &restlen, &resttype, lblock, less);
+	}
+
+	ptrdiff_t rest = pos - restlen;
+	if(llast)
+	{
+		if(resttype)
+		{
+			move_rest(a + rest - lblock, a + rest, restlen);
+			rest = pos;
+			restlen = lblock * nblock2;
+		}
+		else
+		{
+			restlen += lblock * nblock2;
+		}
+		merge_last(a + rest, restlen, llast);
+	}
+	else
+	{
+		move_rest(a + rest - lblock, a + rest, restlen);
+	}
+	return;
+}
+
+
+
+/*
+ * Runs of 2k elements: buffer of k elements is a[-k, 0), pairs are
+ * sorted, then merged level by level to the left through the buffer
+ * (cache for short runs if given). At the end the buffer is at the
+ * start again, after it runs of 2k and a sorted tail.
+ */
+template<typename Iter, typename T, typename Compare>
+void grail_build_blocks(
+	Iter a, ptrdiff_t n, ptrdiff_t k, T *cache, ptrdiff_t cachesize, Compare less
+)
+{
+	ptrdiff_t kbuf = std::min(k, cachesize);
+	while(kbuf & (kbuf - 1))
+		kbuf &= kbuf - 1;
+
+	ptrdiff_t h;
+	if(kbuf)
+	{
+		std::copy(a - kbuf, a, cache);
+		for(ptrdiff_t m = 1; m < n; m += 2)
+		{
+			int const u = less(a[m], a[m-1]) ? 1 : 0;
+			a[m-3] = a[m-1+u];
+			a[m-2] = a[m-u];
+		}
+		if(n % 2)
+			a[n-3] = a[n-1];
+		a -= 2;
+		for(h = 2; h < kbuf; h *= 2)
+		{
+			ptrdiff_t p0 = 0;
+			for(ptrdiff_t const p1 = n - 2*h; p0 <= p1; p0 += 2*h)
+				grail_merge_left_cached(a + p0, h, h, -h, less);
+			ptrdiff_t const rest = n - p0;
+			if(rest > h)
+				grail_merge_left_cached(a + p0, h, rest - h, -h, less);
+			else
+				for(; p0 < n; ++p0)
+					a[p0-h] = a[p0];
+			a -= h;
+		}
+		std::copy(cache, cache + kbuf, a + n);
+	}
+	else
+	{
+		for(ptrdiff_t m = 1; m < n; m += 2)
+		{
+			int const u = less(a[m], a[m-1]) ? 1 : 0;
+			std::swap(a[m-3], a[m-1+u]);
+			std::swap(a[m-2], a[m-u]);
+		}
+		if(n % 2)
+			std::swap(a[n-1], a[n-3]);
+		a -= 2;
+		h = 2;
+	}
+
+	for(; h < k; h *= 2)
+	{
+		ptrdiff_t p0 = 0;
+		for(ptrdiff_t const p1 = n - 2*h; p0 <= p1; p0 += 2*h)
+			grail_merge_left(a + p0, h, h, -h, less);
+		ptrdiff_t const rest = n - p0;
+		if(rest > h)
+			grail_merge_left(a + p0, h, rest - h, -h, less);
+		else
+			grail_rotate(a + p0 - h, h, rest);
+		a -= h;
+	}
+
+	// buffer back to the start: merges to the right
+	ptrdiff_t const restk = n % (2*k);
+	ptrdiff_t p = n - restk;
+	if(restk <= k)
+		grail_rotate(a + p, restk, k);
+	else
+		grail_merge_right(a + p, k, restk - k, k, less);
+	while(p > 0)
+	{
+		p -= 2*k;
+		grail_merge_right(a + p, k, k, k, less);
+	}
+	return;
+}
+
+
+
+/*
+ * Pairs of runs of ll elements are merged by blocks of lblock; keys
+ * at the start tag the blocks, buffer is a[-lblock, 0).
+ */
+template<typename Iter, typename T, typename Compare>
+void grail_combine_blocks(
+	Iter keys, Iter a, ptrdiff_t n, ptrdiff_t ll, ptrdiff_t lblock,
+	bool havebuf, T *cache, Compare less
+)
+{
+	ptrdiff_t const pairs = n / (2*ll);
+	ptrdiff_t lrest = n % (2*ll);
+	if(lrest <= ll)
+	{
+		// tail is one sorted run, nothing to merge it with
+		n -= lrest;
+		lrest = 0;
+	}
+	if(cache)
+		std::copy(a - lblock, a, cache);
+
+	for(ptrdiff_t b = 0; b <= pairs; ++b)
+	{
+		if(b == pairs && lrest == 0)
+			break;
+		Iter const pair = a + b*2*ll;
+		ptrdiff_t const nblock = (b == pairs ? lrest : 2*ll) / lblock;
+		grail_insertion_sort(keys, nblock + (b == pairs ? 1 : 0), less);
+
+		// blocks sorted by first elements, ties by keys (stream order)
+		ptrdiff_t midkey = ll / lblock;
+		for(ptrdiff_t u = 1; u < nblock; ++u)
+		{
+			ptrdiff_t p = u - 1;
+			for(ptrdiff_t v = u; v < nblock; ++v)
+			{
+				int const kc = grail_compare(pair[p*lblock], pair[v*lblock], less);
+				if(kc > 0 || (kc == 0 && less(keys[v], keys[p])))
+					p = v;
+			}
+			if(p != u - 1)
+			{
+				grail_swap_n(pair + (u-1)*lblock, pair + p*lblock, lblock);
+				std::swap(keys[u-1], keys[p]);
+				if(midkey == u - 1 || midkey == p)
+					midkey ^= (u - 1) ^ p;
+			}
+		}
+
+		// first-run blocks which go after the irregular last block
+		ptrdiff_t nblock2 = 0, llast = 0;
+		if(b == pairs)
+			llast = lrest % lblock;
+		if(llast != 0)
+			while(
+				nblock2 < nblock &&
+				less(pair[nblock*lblock], pair[(nblock - nblock2 - 1)*lblock])
+			)
+				++nblock2;
+
+		grail_merge_buffers_left(
+			keys, keys[midkey], pair, nblock - nblock2, lblock,
+			havebuf, cache != nullptr, nblock2, llast, less
+		);
+	}
+
+	// merged runs are shifted left by lblock, buffer goes back before them
+	if(cache)
+	{
+		for(ptrdiff_t p = n; --p >= 0;)
+			a[p] = a[p - lblock];
+		std::copy(cache, cache + lblock, a - lblock);
+	}
+	else if(havebuf)
+	{
+		while(--n >= 0)
+			std::swap(a[n], a[n - lblock]);
+	}
+	return;
+}
+
+
+
+template<typename Iter, typename Compare>
+void grail_lazy_stable_sort(Iter a, ptrdiff_t n, Compare less)
+{
+	for(ptrdiff_t m = 1; m < n; m += 2)
+		if(less(a[m], a[m-1]))
+			std::swap(a[m-1], a[m]);
+	for(ptrdiff_t h = 2; h < n; h *= 2)
+	{
+		ptrdiff_t p0 = 0;
+		for(ptrdiff_t const p1 = n - 2*h; p0 <= p1; p0 += 2*h)
+			grail_merge_without_buffer(a + p0, h, h, less);
+		ptrdiff_t const rest = n - p0;
+		if(rest > h)
+			grail_merge_without_buffer(a + p0, h, rest - h, less);
+	}
+	return;
+}
+
+// cache: cachesize elements or null
+template<typename Iter, typename T, typename Compare>
+void grail_sort_cached(Iter a, ptrdiff_t n, T *cache, ptrdiff_t cachesize, Compare less)
+{
+	if(n < GRAIL_INSERTION)
+	{
+		grail_insertion_sort(a, n, less);
+		return;
+	}
+
+	ptrdiff_t lblock = 1;
+	while(lblock*lblock < n)
+		lblock *= 2;
+	ptrdiff_t nkeys = (n - 1) / lblock + 1;
+
+	ptrdiff_t found;
+	{
+		CLEVER_ZONE("find keys");
+		found = grail_find_keys(a, n, nkeys + lblock, less);
+	}
+	bool havebuf = true;
+	if(found < nkeys + lblock)
+	{
+		if(found < 4)
+		{
+			CLEVER_ZONE("lazy stable sort");
+			grail_lazy_stable_sort(a, n, less);
+			return;
+		}
+		nkeys = lblock;
+		while(nkeys > found)
+			nkeys /= 2;
+		havebuf = false;
+		lblock = 0;
+	}
+
+	ptrdiff_t const ptr = lblock + nkeys;
+	ptrdiff_t cbuf = havebuf ? lblock : nkeys;
+	{
+		CLEVER_ZONE("build blocks");
+		if(havebuf)
+			grail_build_blocks(a + ptr, n - ptr, cbuf, cache, cachesize, less);
+		else
+			grail_build_blocks(a + ptr, n - ptr, cbuf, (T *)nullptr, 0, less);
+	}
+
+	while(n - ptr > (cbuf *= 2))
+	{
+		CLEVER_ZONE("combine blocks");
+		ptrdiff_t lb = lblock;
+		bool chavebuf = havebuf;
+		if(!havebuf)
+		{
+			// keys alone: half of them as buffer if there are enough,
+			// otherwise bigger blocks merged by rotations
+			if(nkeys > 4 && nkeys / 8 * nkeys >= cbuf)
+			{
+				lb = nkeys / 2;
+				chavebuf = true;
+			}
+			else
+			{
+				ptrdiff_t nk = 1;
+				long long s = (long long)cbuf * found / 2;
+				while(nk < nkeys && s != 0)
+				{
+					nk *= 2;
+					s /= 8;
+				}
+				lb = (2*cbuf) / nk;
+			}
+		}
+		grail_combine_blocks(
+			a, a + ptr, n - ptr, cbuf, lb, chavebuf,
+			chavebuf && lb <= cachesize ? cache : nullptr, less
+		);
+	}
+
+	CLEVER_ZONE("merge keys");
+	grail_insertion_sort(a, ptr, less);
+	grail_merge_without_buffer(a, ptr, n - ptr, less);
+	return;
+}
+
+
+
+// generic versions, see compare.cpp
+template<typename Iter, typename Compare = Less, typename Projection = Identity>
+void grail_sort(Iter b, Iter e, Compare comp = Compare(), Projection proj = Projection())
+{
+	typedef typename std::iterator_traits<Iter>::value_type value_type;
+	grail_sort_cached(b, e - b, (value_type *)nullptr, 0, make_compare(comp, proj));
+	return;
+}
+
+template<typename Iter, typename Compare = Less, typename Projection = Identity>
+void grail_cache_sort(Iter b, Iter e, Compare comp = Compare(), Projection proj = Projection())
+{
+	ptrdiff_t size = 1;
+	while(size*size < e - b)
+		size *= 2;
+	std::vector<typename std::iterator_traits<Iter>::value_type> cache(size);
+	grail_sort_cached(b, e - b, cache.data(), size, make_compare(comp, proj));
+	return;
+}
+
+
+
+// no extra memory
+template<typename Array>
+void grail_sort(Array &ar)
+{
+	CLEVER_ZONE("grail_sort");
+	grail_sort(ar.d, ar.d + ar.n);
+	return;
+}
+
+// comparator through a pointer, see FunctionCompare in compare.cpp
+template<typename Array>
+void grail_sort_function_compare(Array &ar)
+{
+	CLEVER_ZONE("grail_sort_function_compare");
+	typedef typename Array::value_type value_type;
+	grail_sort(ar.d, ar.d + ar.n, FunctionCompare<value_type>{ function_less<value_type> });
+	return;
+}
+
+// external cache of a power of two elements up to sqrt(n): O(sqrt(n)) memory
+template<typename Array>
+void grail_cache_sort(Array &ar)
+{
+	CLEVER_ZONE("grail_cache_sort");
+	grail_cache_sort(ar.d, ar.d + ar.n);
+	return;
+}
+
+
+
+
+
+// end
+
+#endif
@@ -1,22 +1,44 @@
+#ifndef BUBBLE_SORT_CPP
+#define BUBBLE_SORT_CPP
+
 #include <utility>
+
+#include <clever/Profiler.hpp>
+
 #include "../structures/random_array.cpp"
+#include "compare.cpp"
 
 
 
 
-void bubble_sort( random_array_type &ar )
+// generic version, see compare.cpp
+template<typename Iter, typename Compare = Less, typename Projection = Identity>
+constexpr void bubble_sort( Iter first, Iter last, Compare comp = Compare(), Projection proj = Projection() )
 {
-	if(ar.n == 0)
+	auto const less = make_compare(comp, proj);
+
+	if(first == last)
 		return;
 
-	for(int *end = ar.d+ar.n; end != ar.d; --end) {
-		for(int *b = ar.d+1; b != end; ++b) {
+	for(Iter end = last; end != first; --end) {
+		for(Iter b = first+1; b != end; ++b) {
 			// if position invalid
-			if( *b < *(b-1) ) {
-				std::swap(*b, *(b-1));
+			if( less(*b, *(b-1)) ) {
+				sort_iter_swap(b, b-1);
 			}
 		}
 	}
 
 	return;
 }
+
+
+template<typename Array>
+void bubble_sort( Array &ar )
+{
+	CLEVER_ZONE("bubble_sort");
+	bubble_sort(ar.d, ar.d+ar.n);
+	return;
+}
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef COMPARE_CPP
+#define COMPARE_CPP
+
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+
+
+
+
+/*
+ * Interface of the generic sorts:
+ *
+ *         name(first, last, comp = Less(), proj = Identity())
+ *
+ * first, last - random access iterators
+ * comp        - strict weak order, comp(a, b) is "a before b"
+ * proj        - applied to elements before comparison, comp(proj(a), proj(b))
+ *
+ * comp and proj are taken by value as types, so calls are inlined
+ * when they are function objects. Sorts without allocations are
+ * constexpr (bubble, selection, insertion, pdq; merge with a given
+ * buffer) and run in constant expressions too. Array-level versions
+ * name(ar) are adapters for the test system; name_function_compare(ar)
+ * is the same sort with FunctionCompare.
+ */
+
+
+
+struct Less
+{
+	template<typename A, typename B>
+	constexpr bool operator()(A const &a, B const &b) const
+	{
+		return a < b;
+	}
+};
+
+struct Identity
+{
+	template<typename T>
+	constexpr T &&operator()(T &&v) const
+	{
+		return std::forward<T>(v);
+	}
+};
+
+
+
+// comp(proj(a), proj(b)), what the sort kernels take
+template<typename Compare, typename Projection>
+struct ProjectedCompare
+{
+	Compare comp;
+	Projection proj;
+
+	template<typename A, typename B>
+	constexpr bool operator()(A const &a, B const &b) const
+	{
+		return comp(proj(a), proj(b));
+	}
+};
+
+template<typename Compare, typename Projection>
+constexpr ProjectedCompare<Compare, Projection> make_compare(Compare comp, Projection proj)
+{
+	return { comp, proj };
+}
+
+// identity projection adds nothing
+template<typename Compare>
+constexpr Compare make_compare(Compare comp, Identity)
+{
+	return comp;
+}
+
+// plain < on arithmetic type: branchless tricks are cheap and correct
+template<typename Compare, typename T>
+constexpr bool is_default_compare()
+{
+	return std::is_same<typename std::remove_cv<Compare>::type, Less>::value &&
+		std::is_arithmetic<T>::value;
+}
+
+
+
+// std::iter_swap is constexpr only since C++20
+template<typename Iter>
+constexpr void sort_iter_swap(Iter a, Iter b)
+{
+	typename std::iterator_traits<Iter>::value_type buf(std::move(*a));
+	*a = std::move(*b);
+	*b = std::move(buf);
+	return;
+}
+
+template<typename InIter, typename OutIter>
+constexpr OutIter sort_move(InIter b, InIter e, OutIter out)
+{
+	for(; b != e; ++b, ++out)
+		*out = std::move(*b);
+	return out;
+}
+
+
+
+/*
+ * Comparator called through a pointer, as qsort() calls it: the
+ * reference point for inlined comparators (*_function_compare sorts).
+ * The pointer is read from a variable with external linkage,
+ * so the compiler can't replace the call by the function.
+ */
+template<typename T>
+bool less_function(T const &a, T const &b)
+{
+	return a < b;
+}
+
+template<typename T>
+bool(*function_less)(T const &, T const &) = &less_function<T>;
+
+template<typename T>
+struct FunctionCompare
+{
+	bool(*less)(T const &, T const &);
+
+	bool operator()(T const &a, T const &b) const
+	{
+		return less(a, b);
+	}
+};
+
+
+
+
+
+// end
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef INDIRECT_SORT_CPP
+#define INDIRECT_SORT_CPP
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <clever/Profiler.hpp>
+
+#include "../structures/random_array.cpp"
+#include "pdq_sort.cpp"
+#include "radix_sort.cpp"
+
+
+
+
+
+/*
+ * Indirect sort for big elements: compact pairs (radix key, index)
+ * are sorted by any engine, then elements are moved once by the
+ * permutation:
+ *
+ *         gather - to a buffer in sorted order, sequential writes and
+ *                  prefetched reads, then back; n elements of memory
+ *         cycles - in place along cycles of the permutation, every
+ *                  element is moved once to a random place
+ *
+ * Ties are ordered by index, so the sort is stable with any engine.
+ * Radix key is order preserving (see radix_sort.cpp), but -0.0 goes
+ * before 0.0. Arrays up to 2^32-1 elements.
+ */
+constexpr size_t const INDIRECT_PREFETCH = 8u;
+
+
+
+template<typename K>
+struct IndirectKey
+{
+	K key;
+	uint32_t index;
+};
+
+template<typename K>
+inline bool operator<(IndirectKey<K> const &lhs, IndirectKey<K> const &rhs)
+{
+	return lhs.key < rhs.key || (lhs.key == rhs.key && lhs.index < rhs.index);
+}
+
+template<typename K>
+struct IndirectKeyArray
+{
+	typedef IndirectKey<K> value_type;
+
+	value_type *d;
+	size_t n;
+};
+
+// array of pairs for elements T
+template<typename T>
+using indirect_array_type = IndirectKeyArray<typename RadixKey<T>::type>;
+
+
+
+template<typename T, typename K>
+void indirect_gather(T *d, size_t n, IndirectKey<K> const *keys)
+{
+	static thread_local std::vector<T> buf;
+	if(buf.size() < n)
+		buf.resize(n);
+
+	for(size_t i = 0; i < n; ++i)
+	{
+#ifdef __GNUC__
+		if(i + INDIRECT_PREFETCH < n)
+			__builtin_prefetch(d + keys[i + INDIRECT_PREFETCH].index);
+#endif
+		buf[i] = std::move(d[keys[i].index]);
+	}
+	std::move(buf.begin(), buf.begin() + n, d);
+	return;
+}
+
+// position i takes element keys[i].index; done positions are marked
+// by index equal to position
+template<typename T, typename K>
+void indirect_cycles(T *d, size_t n, IndirectKey<K> *keys)
+{
+	for(size_t i = 0; i < n; ++i)
+	{
+		if(keys[i].index == i)
+			continue;
+		T buf = std::move(d[i]);
+		size_t j = i;
+		for(size_t k; (k = keys[j].index) != i; j = k)
+		{
+			d[j] = std::move(d[k]);
+			keys[j].index = uint32_t(j);
+		}
+		d[j] = std::move(buf);
+		keys[j].index = uint32_t(j);
+	}
+	return;
+}
+
+
+
+template<
+	typename Array,
+	void(*Sort)(indirect_array_type<typename Array::value_type> &),
+	bool Cycles
+>
+void indirect_sort(Array &ar)
+{
+	typedef typename Array::value_type value_type;
+	typedef indirect_array_type<value_type> key_array;
+
+	static thread_local std::vector<typename key_array::value_type> keys;
+	keys.resize(ar.n);
+	{
+		CLEVER_ZONE("keys");
+		for(size_t i = 0; i < ar.n; ++i)
+			keys[i] = { RadixKey<value_type>::get(ar.d[i]), uint32_t(i) };
+	}
+
+	key_array pairs { keys.data(), ar.n };
+	Sort(pairs);
+
+	CLEVER_ZONE("permutation");
+	if(Cycles)
+		indirect_cycles(ar.d, ar.n, keys.data());
+	else
+		indirect_gather(ar.d, ar.n, keys.data());
+	return;
+}
+
+
+
+template<typename Array>
+void indirect_pdq_sort(Array &ar)
+{
+	CLEVER_ZONE("indirect_pdq_sort");
+	typedef indirect_array_type<typename Array::value_type> key_array;
+	indirect_sort<Array, &pdq_sort<key_array>, false>(ar);
+	return;
+}
+
+template<typename Array>
+void indirect_pdq_cycle_sort(Array &ar)
+{
+	CLEVER_ZONE("indirect_pdq_cycle_sort");
+	typedef indirect_array_type<typename Array::value_type> key_array;
+	indirect_sort<Array, &pdq_sort<key_array>, true>(ar);
+	return;
+}
+
+// radix sort of pairs by key only, stable
+template<typename Array>
+void indirect_radix_sort(Array &ar)
+{
+	CLEVER_ZONE("indirect_radix_sort");
+	typedef indirect_array_type<typename Array::value_type> key_array;
+	indirect_sort<Array, &radix_sort<key_array>, false>(ar);
+	return;
+}
+
+template<typename Array>
+void indirect_radix_cycle_sort(Array &ar)
+{
+	CLEVER_ZONE("indirect_radix_cycle_sort");
+	typedef indirect_array_type<typename Array::value_type> key_array;
+	indirect_sort<Array, &radix_sort<key_array>, true>(ar);
+	return;
+}
+
+
+
+
+
+// end
+
+#endif
@@ -1,31 +1,64 @@
+#ifndef INSERTION_SORT_CPP
+#define INSERTION_SORT_CPP
+
+#include <iterator>
 #include <utility>
+
+#include <clever/Profiler.hpp>
+
 #include "../structures/random_array.cpp"
+#include "compare.cpp"
 
 
 
 
 
-void insertion_sort(random_array_type &ar)
+// generic version, see compare.cpp
+template<typename Iter, typename Compare = Less, typename Projection = Identity>
+constexpr void insertion_sort(Iter b, Iter e, Compare comp = Compare(), Projection proj = Projection())
 {
-	int buf;
-	int *j;
-	for(int *i = ar.d+1, *ie = ar.d+ar.n; i < ie; ++i)
+	auto const less = make_compare(comp, proj);
+
+	if(b == e)
+		return;
+	for(Iter i = b+1; i != e; ++i)
 	{
-		buf = *i;
-		j = i-1;
-		while(j >= ar.d && buf < *j)
+		typename std::iterator_traits<Iter>::value_type buf(std::move(*i));
+		Iter j = i;
+		while(j != b && less(buf, *(j-1)))
 		{
-			*(j+1) = *j;
+			*j = std::move(*(j-1));
 			--j;
 		}
-		*(j+1) = buf;
+		*j = std::move(buf);
 	}
 
 	return;
 }
 
 
+template<typename Array>
+void insertion_sort(Array &ar)
+{
+	CLEVER_ZONE("insertion_sort");
+	insertion_sort(ar.d, ar.d + ar.n);
+	return;
+}
+
+// comparator through a pointer, see FunctionCompare in compare.cpp
+template<typename Array>
+void insertion_sort_function_compare(Array &ar)
+{
+	CLEVER_ZONE("insertion_sort_function_compare");
+	typedef typename Array::value_type value_type;
+	insertion_sort(ar.d, ar.d + ar.n, FunctionCompare<value_type>{ function_less<value_type> });
+	return;
+}
+
+
 
 
 
 // end
+
+#endif
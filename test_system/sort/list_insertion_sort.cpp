@@ -0,0 +1,57 @@
+#ifndef LIST_INSERTION_SORT_CPP
+#define LIST_INSERTION_SORT_CPP
+
+#include <clever/Profiler.hpp>
+
+#include "../structures/linked_list.cpp"
+
+
+
+
+
+// insertion sort of singly linked list, nodes are relinked
+template<typename List>
+void list_insertion_sort(List &list)
+{
+	typedef typename List::node_type node_type;
+	CLEVER_ZONE("list_insertion_sort");
+
+	node_type *sorted = nullptr;
+	node_type *tail = nullptr;
+
+	for(node_type *rest = list.head; rest; )
+	{
+		node_type *node = rest;
+		rest = rest->next;
+
+		// not less than the last one: append, sorted input is O(n)
+		if(!tail || !(node->value < tail->value))
+		{
+			node->next = nullptr;
+			if(tail)
+				tail->next = node;
+			else
+				sorted = node;
+			tail = node;
+			continue;
+		}
+
+		// after all equal elements (stability)
+		node_type **pos = &sorted;
+		while(!(node->value < (*pos)->value))
+			pos = &(*pos)->next;
+		node->next = *pos;
+		*pos = node;
+	}
+	list.head = sorted;
+
+	return;
+}
+
+
+
+
+
+// end
+
+#endif
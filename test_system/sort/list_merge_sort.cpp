@@ -0,0 +1,87 @@
+#ifndef LIST_MERGE_SORT_CPP
+#define LIST_MERGE_SORT_CPP
+
+#include <clever/Profiler.hpp>
+
+#include "../structures/linked_list.cpp"
+
+
+
+
+
+// merge of two sorted lists, equal elements are taken from the first
+template<typename Node>
+Node *merge_lists(Node *first, Node *second)
+{
+	Node *head = nullptr;
+	Node **tail = &head;
+
+	while(first && second)
+	{
+		if(second->value < first->value)
+		{
+			*tail = second;
+			second = second->next;
+		}
+		else
+		{
+			*tail = first;
+			first = first->next;
+		}
+		tail = &(*tail)->next;
+	}
+	*tail = first ? first : second;
+
+	return head;
+}
+
+
+
+/*
+ * bottom-up merge sort of singly linked list, no extra memory:
+ * bins[i] holds sorted list of 2^i nodes, every next node
+ * is carried through the bins like a binary counter
+ */
+template<typename List>
+void list_merge_sort(List &list)
+{
+	typedef typename List::node_type node_type;
+	CLEVER_ZONE("list_merge_sort");
+
+	node_type *bins[64] = {};
+	unsigned int used = 0;
+
+	for(node_type *rest = list.head; rest; )
+	{
+		node_type *carry = rest;
+		rest = rest->next;
+		carry->next = nullptr;
+
+		unsigned int i = 0;
+		for(; bins[i]; ++i)
+		{
+			// bins hold earlier nodes (stability)
+			carry = merge_lists(bins[i], carry);
+			bins[i] = nullptr;
+		}
+		bins[i] = carry;
+		if(i >= used)
+			used = i+1;
+	}
+
+	node_type *result = nullptr;
+	for(unsigned int i = 0; i < used; ++i)
+		if(bins[i])
+			result = merge_lists(bins[i], result);
+	list.head = result;
+
+	return;
+}
+
+
+
+
+
+// end
+
+#endif
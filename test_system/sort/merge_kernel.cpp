@@ -0,0 +1,283 @@
+#ifndef MERGE_KERNEL_CPP
+#define MERGE_KERNEL_CPP
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+	#define MERGE_KERNEL_X86
+#endif
+
+#include <clever/Profiler.hpp>
+
+#include "../structures/random_array.cpp"
+#include "merge_sort.cpp"
+#include "pingpong_merge_sort.cpp"
+
+
+
+
+
+/*
+ * Merge kernels:
+ *
+ *         merge()                 - goto loop with a branch per element,
+ *                                   see merge_sort.cpp
+ *         branchless_merge()      - the branch becomes conditional moves
+ *                                   and index arithmetic
+ *         avx2_merge()            - bitonic merge network on blocks of
+ *                                   8 (int32) or 4 (int64) keys
+ *         kernel_merge()          - avx2_merge() for 32- and 64-bit signed
+ *                                   integers if the CPU has AVX2,
+ *                                   branchless_merge() otherwise
+ *
+ * All of them merge [fb, fe) and [sb, se) into out and take equal
+ * elements from the first range. avx2_merge() may mix equal keys,
+ * which can't be told apart for plain integers.
+ */
+template<typename T>
+void branchless_merge(T const *fb, T const *fe, T const *sb, T const *se, T *out)
+{
+	while(fb != fe && sb != se)
+	{
+		T const f = *fb, s = *sb;
+		bool const second = s < f;
+		*out++ = second ? s : f;
+		fb += !second;
+		sb += second;
+	}
+	out = std::copy(fb, fe, out);
+	std::copy(sb, se, out);
+	return;
+}
+
+
+
+#ifdef MERGE_KERNEL_X86
+
+inline bool cpu_has_avx2()
+{
+	static bool const has = __builtin_cpu_supports("avx2");
+	return has;
+}
+
+
+
+// 8 x int32: sorted bitonic sequence
+__attribute__((target("avx2")))
+inline __m256i avx2_bitonic_sort(__m256i v)
+{
+	__m256i x = _mm256_permute2x128_si256(v, v, 0x01);
+	v = _mm256_blend_epi32(_mm256_min_epi32(v, x), _mm256_max_epi32(v, x), 0xF0);
+	x = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+	v = _mm256_blend_epi32(_mm256_min_epi32(v, x), _mm256_max_epi32(v, x), 0xCC);
+	x = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+	v = _mm256_blend_epi32(_mm256_min_epi32(v, x), _mm256_max_epi32(v, x), 0xAA);
+	return v;
+}
+
+// two sorted vectors: lo gets 8 smallest, hi 8 biggest, both sorted
+__attribute__((target("avx2")))
+inline void avx2_merge_network(__m256i &lo, __m256i &hi, int32_t)
+{
+	__m256i const r = _mm256_permutevar8x32_epi32(
+		hi, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0)
+	);
+	__m256i const l = _mm256_min_epi32(lo, r);
+	__m256i const h = _mm256_max_epi32(lo, r);
+	lo = avx2_bitonic_sort(l);
+	hi = avx2_bitonic_sort(h);
+	return;
+}
+
+
+
+// 4 x int64: no min/max in AVX2, compare and blend
+__attribute__((target("avx2")))
+inline void avx2_minmax64(__m256i a, __m256i b, __m256i &mn, __m256i &mx)
+{
+	__m256i const gt = _mm256_cmpgt_epi64(a, b);
+	mn = _mm256_blendv_epi8(a, b, gt);
+	mx = _mm256_blendv_epi8(b, a, gt);
+	return;
+}
+
+__attribute__((target("avx2")))
+inline __m256i avx2_bitonic_sort64(__m256i v)
+{
+	__m256i mn, mx;
+	avx2_minmax64(v, _mm256_permute4x64_epi64(v, _MM_SHUFFLE(1, 0, 3, 2)), mn, mx);
+	v = _mm256_blend_epi32(mn, mx, 0xF0);
+	avx2_minmax64(v, _mm256_permute4x64_epi64(v, _MM_SHUFFLE(2, 3, 0, 1)), mn, mx);
+	v = _mm256_blend_epi32(mn, mx, 0xCC);
+	return v;
+}
+
+__attribute__((target("avx2")))
+inline void avx2_merge_network(__m256i &lo, __m256i &hi, int64_t)
+{
+	__m256i const r = _mm256_permute4x64_epi64(hi, _MM_SHUFFLE(0, 1, 2, 3));
+	__m256i l, h;
+	avx2_minmax64(lo, r, l, h);
+	lo = avx2_bitonic_sort64(l);
+	hi = avx2_bitonic_sort64(h);
+	return;
+}
+
+
+
+/*
+ * Block merge: the network gives the smallest W keys of two blocks,
+ * the biggest W stay in register and meet the next block, taken
+ * from the range with the smaller next key. Tails shorter than
+ * a block are merged by branchless_merge().
+ */
+template<typename T>
+__attribute__((target("avx2")))
+void avx2_merge(T const *fb, T const *fe, T const *sb, T const *se, T *out)
+{
+	static_assert(
+		std::is_same<T, int32_t>::value || std::is_same<T, int64_t>::value,
+		"avx2_merge() works with int32_t and int64_t"
+	);
+	constexpr ptrdiff_t const W = 32 / sizeof(T);
+
+	if(fe - fb < W || se - sb < W)
+	{
+		branchless_merge(fb, fe, sb, se, out);
+		return;
+	}
+
+	__m256i lo = _mm256_loadu_si256((__m256i const *)fb);
+	__m256i hi = _mm256_loadu_si256((__m256i const *)sb);
+	fb += W;
+	sb += W;
+
+	for(;;)
+	{
+		avx2_merge_network(lo, hi, T());
+		_mm256_storeu_si256((__m256i *)out, lo);
+		out += W;
+
+		bool const first = sb == se || (fb != fe && *fb <= *sb);
+		T const *&from = first ? fb : sb;
+		T const *const end = first ? fe : se;
+		if(end - from < W)
+			break;
+		lo = _mm256_loadu_si256((__m256i const *)from);
+		from += W;
+	}
+
+	// keys left in register go before the rest of both ranges
+	// where they are smaller, so merge them with the short one
+	T left[W], shortmerged[2*W];
+	_mm256_storeu_si256((__m256i *)left, hi);
+	bool const firstshort = fe - fb < W;
+	T const *const sbeg = firstshort ? fb : sb;
+	T const *const send = firstshort ? fe : se;
+	branchless_merge(left, left + W, sbeg, send, shortmerged);
+	T const *const mend = shortmerged + W + (send - sbeg);
+	if(firstshort)
+		branchless_merge(shortmerged, mend, sb, se, out);
+	else
+		branchless_merge(fb, fe, shortmerged, mend, out);
+	return;
+}
+
+#endif
+
+
+
+template<typename T>
+void kernel_merge(T const *fb, T const *fe, T const *sb, T const *se, T *out)
+{
+#ifdef MERGE_KERNEL_X86
+	if constexpr(
+		std::is_integral<T>::value && std::is_signed<T>::value &&
+		(sizeof(T) == 4 || sizeof(T) == 8)
+	) {
+		typedef typename std::conditional<
+			sizeof(T) == 4, int32_t, int64_t
+		>::type key_type;
+		if(cpu_has_avx2())
+		{
+			avx2_merge(
+				(key_type const *)fb, (key_type const *)fe,
+				(key_type const *)sb, (key_type const *)se,
+				(key_type *)out
+			);
+			return;
+		}
+	}
+#endif
+	branchless_merge(fb, fe, sb, se, out);
+	return;
+}
+
+
+
+
+
+/*
+ * Kernels alone: input is two sorted halves (--distribution=runs:2),
+ * merged into a buffer living between calls.
+ */
+template<typename Array, typename Merge>
+void merge_halves(Array &ar, Merge merge_runs)
+{
+	typedef typename Array::value_type value_type;
+	static thread_local std::vector<value_type> out;
+	if(out.size() < ar.n)
+		out.resize(ar.n);
+
+	value_type *const d = ar.d;
+	merge_runs(d, d + ar.n/2, d + ar.n/2, d + ar.n, out.data());
+	return;
+}
+
+template<typename Array>
+void goto_merge_kernel(Array &ar)
+{
+	typedef typename Array::value_type value_type;
+	CLEVER_ZONE("goto_merge_kernel");
+	merge_halves(ar, &merge<value_type *>);
+	return;
+}
+
+template<typename Array>
+void branchless_merge_kernel(Array &ar)
+{
+	CLEVER_ZONE("branchless_merge_kernel");
+	merge_halves(ar, &branchless_merge<typename Array::value_type>);
+	return;
+}
+
+template<typename Array>
+void simd_merge_kernel(Array &ar)
+{
+	CLEVER_ZONE("simd_merge_kernel");
+	merge_halves(ar, &kernel_merge<typename Array::value_type>);
+	return;
+}
+
+
+
+// bottom-up merge sort with kernel_merge() as merge step
+template<typename Array>
+void kernel_merge_sort(Array &ar)
+{
+	CLEVER_ZONE("kernel_merge_sort");
+	pingpong_merge_sort_by(ar, &kernel_merge<typename Array::value_type>);
+	return;
+}
+
+
+
+
+
+// end
+
+#endif
@@ -1,13 +1,57 @@
-#include <cstring>
+#ifndef MERGE_SORT_CPP
+#define MERGE_SORT_CPP
+
 #include <iterator>
 #include <utility>
+#include <vector>
+
+#include <clever/Profiler.hpp>
+
 #include "../structures/random_array.cpp"
+#include "compare.cpp"
+
 
 
 
 
+// merge by comparator, loop without goto (constexpr)
+template<typename Iter, typename OutIter, typename Compare>
+constexpr void merge(Iter fbeg, Iter fend, Iter sbeg, Iter send, OutIter out, Compare less)
+{
+	while(fbeg != fend && sbeg != send)
+	{
+		// equal elements are taken from the first range (stability)
+		if(less(*sbeg, *fbeg))
+		{
+			*out = *sbeg;
+			++sbeg;
+		}
+		else
+		{
+			*out = *fbeg;
+			++fbeg;
+		}
+		++out;
+	}
+
+	while(fbeg != fend)
+	{
+		*out = *fbeg;
+		++fbeg;
+		++out;
+	}
+	while(sbeg != send)
+	{
+		*out = *sbeg;
+		++sbeg;
+		++out;
+	}
+
+	return;
+}
 
-// merge
+// the same by <, goto loop (goto_merge_kernel in merge_kernel.cpp);
+// merge step of pingpong_merge_sort_by() and merge_halves()
 template<typename Iter>
 void merge(Iter fbeg, Iter fend, Iter sbeg, Iter send, Iter out)
 {
@@ -37,15 +81,16 @@ loop:
 	}
 
 
-	if(*fbeg < *sbeg)
+	// equal elements are taken from the first range (stability)
+	if(*sbeg < *fbeg)
 	{
-		*out = *fbeg;
-		++fbeg;
+		*out = *sbeg;
+		++sbeg;
 	}
 	else
 	{
-		*out = *sbeg;
-		++sbeg;
+		*out = *fbeg;
+		++fbeg;
 	}
 	++out;
 
@@ -55,41 +100,71 @@ loop:
 
 
 // algorithm implement
-// array representate by pointer
-template<typename T>
-void merge_sort(T *b, T *e, T *buf)
+// array representate by iterators, buf has e-b elements
+template<typename Iter, typename BufIter, typename Compare>
+constexpr void merge_sort_buffered(Iter b, Iter e, BufIter buf, Compare less)
 {
-	using namespace std;
+	CLEVER_ZONE("merge_sort");
+
 	// check distance
-	int dis = distance(b, e);
+	auto const dis = e - b;
 	if(dis < 2)
 		return;
 	else if(dis == 2)
 	{
-		if(*next(b) < *b)
-			swap(*next(b), *b);
+		if(less(*(b+1), *b))
+			sort_iter_swap(b+1, b);
 
 		return;
 	}
 
 	// sorting halfs
-	T *half = b + dis/2;
-	merge_sort(b, half, buf);
-	merge_sort(half, e, buf);
+	Iter half = b + dis/2;
+	merge_sort_buffered(b, half, buf, less);
+	merge_sort_buffered(half, e, buf, less);
 
-	merge(b, half, half, e, buf);
-	memcpy( b, buf, sizeof(*buf) * dis );
+	{
+		CLEVER_ZONE("merge");
+		merge(b, half, half, e, buf, less);
+	}
+	{
+		CLEVER_ZONE("copy back");
+		sort_move(buf, buf+dis, b);
+	}
+
+	return;
+}
 
+// generic version, see compare.cpp
+template<typename Iter, typename Compare = Less, typename Projection = Identity>
+void merge_sort(Iter b, Iter e, Compare comp = Compare(), Projection proj = Projection())
+{
+	std::vector<typename std::iterator_traits<Iter>::value_type> buf(e - b);
+	merge_sort_buffered(b, e, buf.begin(), make_compare(comp, proj));
 	return;
 }
 
 
 // algorithm
-void merge_sort(random_array_type &ar)
+template<typename Array>
+void merge_sort(Array &ar)
 {
-	std::cout << 'm' << std::endl;
-	int *buf = new int[ar.n];
-	merge_sort( ar.d, ar.d+ar.n, buf );
+	auto *buf = new typename Array::value_type[ar.n];
+	merge_sort_buffered( ar.d, ar.d+ar.n, buf, Less() );
+	delete[] buf;
+	return;
+}
+
+// comparator through a pointer, see FunctionCompare in compare.cpp
+template<typename Array>
+void merge_sort_function_compare(Array &ar)
+{
+	CLEVER_ZONE("merge_sort_function_compare");
+	typedef typename Array::value_type value_type;
+	auto *buf = new value_type[ar.n];
+	merge_sort_buffered(
+		ar.d, ar.d+ar.n, buf, FunctionCompare<value_type>{ function_less<value_type> }
+	);
 	delete[] buf;
 	return;
 }
@@ -99,3 +174,5 @@ void merge_sort(random_array_type &ar)
 
 
 // end
+
+#endif
@@ -0,0 +1,361 @@
+#ifndef NETWORK_SORT_CPP
+#define NETWORK_SORT_CPP
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include <clever/Profiler.hpp>
+
+#include "../structures/random_array.cpp"
+#include "merge_kernel.cpp"
+#include "merge_sort.cpp"
+#include "pingpong_merge_sort.cpp"
+
+
+
+
+
+// biggest block sorted by network_sort_block()
+constexpr unsigned int const NETWORK_BLOCK = 64u;
+
+
+
+/*
+ * Sorting networks for blocks up to NETWORK_BLOCK keys: a fixed
+ * sequence of compare-exchanges, the same for every input, so there
+ * are no branches to mispredict.
+ *
+ *         avx2_network_sort()     - int32 in AVX2 registers, 8 keys each:
+ *                                   registers are sorted (64 keys: columns
+ *                                   across registers, then 8x8 transpose),
+ *                                   then joined by bitonic merges
+ *         scalar_network_sort()   - bitonic sort of other arithmetic
+ *                                   types, min/max become conditional moves
+ *
+ * The block is padded with the biggest key (+inf for floating point)
+ * up to 8, 16, 32 or 64.
+ * Networks may mix equal keys, so records (and other types without
+ * a biggest key) are sorted by stable insertion instead.
+ */
+
+
+
+#ifdef MERGE_KERNEL_X86
+
+// compare-exchange of lanes v[i] and x[i] = v[perm(i)], max goes to MASK lanes
+template<int MASK>
+__attribute__((target("avx2")))
+inline __m256i avx2_exchange_lanes(__m256i v, __m256i x)
+{
+	return _mm256_blend_epi32(_mm256_min_epi32(v, x), _mm256_max_epi32(v, x), MASK);
+}
+
+__attribute__((target("avx2")))
+inline __m256i avx2_permute_lanes(__m256i v, int i0, int i1, int i2, int i3, int i4, int i5, int i6, int i7)
+{
+	return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(i0, i1, i2, i3, i4, i5, i6, i7));
+}
+
+
+
+// 8 keys of one register, 19 comparators in 6 layers
+__attribute__((target("avx2")))
+inline __m256i avx2_sort8(__m256i v)
+{
+	// (0,2) (1,3) (4,6) (5,7)
+	v = avx2_exchange_lanes<0xCC>(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+	// (0,4) (1,5) (2,6) (3,7)
+	v = avx2_exchange_lanes<0xF0>(v, _mm256_permute2x128_si256(v, v, 0x01));
+	// (0,1) (2,3) (4,5) (6,7)
+	v = avx2_exchange_lanes<0xAA>(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+	// (2,4) (3,5)
+	v = avx2_exchange_lanes<0x30>(v, avx2_permute_lanes(v, 0, 1, 4, 5, 2, 3, 6, 7));
+	// (1,4) (3,6)
+	v = avx2_exchange_lanes<0x50>(v, avx2_permute_lanes(v, 0, 4, 2, 6, 1, 5, 3, 7));
+	// (1,2) (3,4) (5,6)
+	v = avx2_exchange_lanes<0x54>(v, avx2_permute_lanes(v, 0, 2, 1, 4, 3, 6, 5, 7));
+	return v;
+}
+
+// compare-exchange of whole registers
+__attribute__((target("avx2")))
+inline void avx2_exchange(__m256i &a, __m256i &b)
+{
+	__m256i const mn = _mm256_min_epi32(a, b);
+	b = _mm256_max_epi32(a, b);
+	a = mn;
+	return;
+}
+
+// the same network across 8 registers: every column gets sorted
+__attribute__((target("avx2")))
+inline void avx2_sort_columns(__m256i *v)
+{
+	avx2_exchange(v[0], v[2]); avx2_exchange(v[1], v[3]);
+	avx2_exchange(v[4], v[6]); avx2_exchange(v[5], v[7]);
+	avx2_exchange(v[0], v[4]); avx2_exchange(v[1], v[5]);
+	avx2_exchange(v[2], v[6]); avx2_exchange(v[3], v[7]);
+	avx2_exchange(v[0], v[1]); avx2_exchange(v[2], v[3]);
+	avx2_exchange(v[4], v[5]); avx2_exchange(v[6], v[7]);
+	avx2_exchange(v[2], v[4]); avx2_exchange(v[3], v[5]);
+	avx2_exchange(v[1], v[4]); avx2_exchange(v[3], v[6]);
+	avx2_exchange(v[1], v[2]); avx2_exchange(v[3], v[4]);
+	avx2_exchange(v[5], v[6]);
+	return;
+}
+
+// columns become registers
+__attribute__((target("avx2")))
+inline void avx2_transpose8(__m256i *v)
+{
+	__m256i t[8], u[8];
+	for(unsigned int i = 0; i < 8; i += 2)
+	{
+		t[i] = _mm256_unpacklo_epi32(v[i], v[i+1]);
+		t[i+1] = _mm256_unpackhi_epi32(v[i], v[i+1]);
+	}
+	for(unsigned int i = 0; i < 8; i += 4)
+	{
+		u[i] = _mm256_unpacklo_epi64(t[i], t[i+2]);
+		u[i+1] = _mm256_unpackhi_epi64(t[i], t[i+2]);
+		u[i+2] = _mm256_unpacklo_epi64(t[i+1], t[i+3]);
+		u[i+3] = _mm256_unpackhi_epi64(t[i+1], t[i+3]);
+	}
+	for(unsigned int i = 0; i < 4; ++i)
+	{
+		v[i] = _mm256_permute2x128_si256(u[i], u[i+4], 0x20);
+		v[i+4] = _mm256_permute2x128_si256(u[i], u[i+4], 0x31);
+	}
+	return;
+}
+
+
+
+// bitonic sequence of R registers becomes sorted
+template<unsigned int R>
+__attribute__((target("avx2")))
+inline void avx2_bitonic_clean(__m256i *v)
+{
+	for(unsigned int stride = R/2; stride > 0; stride /= 2)
+		for(unsigned int i = 0; i < R; ++i)
+			if(!(i & stride))
+				avx2_exchange(v[i], v[i+stride]);
+	for(unsigned int i = 0; i < R; ++i)
+		v[i] = avx2_bitonic_sort(v[i]);
+	return;
+}
+
+// sorted runs v[0, R) and v[R, 2R) become sorted v[0, 2R)
+template<unsigned int R>
+__attribute__((target("avx2")))
+inline void avx2_merge_registers(__m256i *v)
+{
+	__m256i reversed[R];
+	for(unsigned int i = 0; i < R; ++i)
+		reversed[i] = avx2_permute_lanes(v[2*R-1-i], 7, 6, 5, 4, 3, 2, 1, 0);
+	for(unsigned int i = 0; i < R; ++i)
+	{
+		v[R+i] = _mm256_max_epi32(v[i], reversed[i]);
+		v[i] = _mm256_min_epi32(v[i], reversed[i]);
+	}
+	avx2_bitonic_clean<R>(v);
+	avx2_bitonic_clean<R>(v + R);
+	return;
+}
+
+template<unsigned int K>
+__attribute__((target("avx2")))
+inline void avx2_sort_registers(__m256i *v)
+{
+	if constexpr(K == 8)
+	{
+		avx2_sort_columns(v);
+		avx2_transpose8(v);
+	}
+	else
+	{
+		for(unsigned int i = 0; i < K; ++i)
+			v[i] = avx2_sort8(v[i]);
+	}
+
+	if constexpr(K >= 2)
+		for(unsigned int b = 0; b < K; b += 2)
+			avx2_merge_registers<1>(v + b);
+	if constexpr(K >= 4)
+		for(unsigned int b = 0; b < K; b += 4)
+			avx2_merge_registers<2>(v + b);
+	if constexpr(K >= 8)
+		avx2_merge_registers<4>(v);
+	return;
+}
+
+template<unsigned int K>
+__attribute__((target("avx2")))
+void avx2_network_sort(int32_t *d, size_t n)
+{
+	alignas(32) int32_t padded[8*K];
+	int32_t *const src = n == 8*K ? d : padded;
+	if(src == padded)
+	{
+		std::copy(d, d + n, padded);
+		std::fill(padded + n, padded + 8*K, std::numeric_limits<int32_t>::max());
+	}
+
+	__m256i v[K];
+	for(unsigned int i = 0; i < K; ++i)
+		v[i] = _mm256_loadu_si256((__m256i const *)(src + 8*i));
+	avx2_sort_registers<K>(v);
+	for(unsigned int i = 0; i < K; ++i)
+		_mm256_storeu_si256((__m256i *)(src + 8*i), v[i]);
+
+	if(src == padded)
+		std::copy(padded, padded + n, d);
+	return;
+}
+
+#endif
+
+
+
+// key for padding, not less than any key of the type
+template<typename T>
+constexpr T network_pad_key()
+{
+	return std::numeric_limits<T>::has_infinity ?
+		std::numeric_limits<T>::infinity() :
+		std::numeric_limits<T>::max();
+}
+
+template<typename T>
+void scalar_network_sort(T *d, size_t n)
+{
+	T padded[NETWORK_BLOCK];
+	size_t size = 2;
+	while(size < n)
+		size *= 2;
+	std::copy(d, d + n, padded);
+	std::fill(padded + n, padded + size, network_pad_key<T>());
+
+	for(size_t k = 2; k <= size; k *= 2)
+		for(size_t j = k/2; j > 0; j /= 2)
+			for(size_t i = 0; i < size; ++i)
+			{
+				size_t const l = i ^ j;
+				if(l < i)
+					continue;
+				// one comparison for both: std::min and std::max
+				// return the same of equal keys (-0.0 and 0.0)
+				T const a = padded[i], b = padded[l];
+				bool const swapped = b < a;
+				T const lo = swapped ? b : a, hi = swapped ? a : b;
+				bool const up = !(i & k);
+				padded[i] = up ? lo : hi;
+				padded[l] = up ? hi : lo;
+			}
+
+	std::copy(padded, padded + n, d);
+	return;
+}
+
+
+
+// sorts [b, e), at most NETWORK_BLOCK elements
+template<typename T>
+void network_sort_block(T *b, T *e)
+{
+	size_t const n = e - b;
+	if(n < 2)
+		return;
+
+#ifdef MERGE_KERNEL_X86
+	if constexpr(
+		std::is_integral<T>::value && std::is_signed<T>::value && sizeof(T) == 4
+	) {
+		if(cpu_has_avx2())
+		{
+			int32_t *const d = (int32_t *)b;
+			if(n <= 8)
+				avx2_network_sort<1>(d, n);
+			else if(n <= 16)
+				avx2_network_sort<2>(d, n);
+			else if(n <= 32)
+				avx2_network_sort<4>(d, n);
+			else
+				avx2_network_sort<8>(d, n);
+			return;
+		}
+	}
+#endif
+
+	if constexpr(std::is_arithmetic<T>::value)
+		scalar_network_sort(b, n);
+	else
+		pingpong_insertion(b, e);
+	return;
+}
+
+
+
+
+
+// merge_sort() with blocks of NETWORK_BLOCK sorted by network instead of pairs
+template<typename T>
+void network_merge_sort(T *b, T *e, T *buf)
+{
+	size_t const dis = e - b;
+	if(dis <= NETWORK_BLOCK)
+	{
+		CLEVER_ZONE("network block");
+		network_sort_block(b, e);
+		return;
+	}
+
+	T *half = b + dis/2;
+	network_merge_sort(b, half, buf);
+	network_merge_sort(half, e, buf);
+
+	{
+		CLEVER_ZONE("merge");
+		merge(b, half, half, e, buf);
+	}
+	{
+		CLEVER_ZONE("copy back");
+		std::copy(buf, buf+dis, b);
+	}
+
+	return;
+}
+
+template<typename Array>
+void network_merge_sort(Array &ar)
+{
+	CLEVER_ZONE("network_merge_sort");
+	auto *buf = new typename Array::value_type[ar.n];
+	network_merge_sort(ar.d, ar.d+ar.n, buf);
+	delete[] buf;
+	return;
+}
+
+
+
+// small arrays (up to NETWORK_BLOCK) by one network, bigger by network_merge_sort()
+template<typename Array>
+void network_sort(Array &ar)
+{
+	CLEVER_ZONE("network_sort");
+	if(ar.n > NETWORK_BLOCK)
+		network_merge_sort(ar);
+	else
+		network_sort_block(ar.d, ar.d+ar.n);
+	return;
+}
+
+
+
+
+
+// end
+
+#endif
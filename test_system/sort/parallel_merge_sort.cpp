@@ -0,0 +1,189 @@
+#ifndef PARALLEL_MERGE_SORT_CPP
+#define PARALLEL_MERGE_SORT_CPP
+
+#include <algorithm>
+#include <vector>
+
+#include <clever/Profiler.hpp>
+#include <clever/TaskPool.hpp>
+
+#include "../structures/random_array.cpp"
+#include "merge_kernel.cpp"
+#include "pingpong_merge_sort.cpp"
+
+
+
+
+
+/*
+ * Settings of parallel sorts, set before the first sort:
+ *
+ *         cutoff  - ranges up to cutoff elements are sorted (and merged)
+ *                   by one thread
+ *         threads - threads of the pool with the calling one,
+ *                   0 is one per core; the pool is created on first use
+ *         samplebase - sample_sort ranges up to samplebase elements
+ *                   are sorted by pdq_sort (at least 32, so a sample
+ *                   always fits)
+ */
+struct ParallelSortSettings
+{
+	size_t cutoff = 8192u;
+	unsigned int threads = 0u;
+	size_t samplebase = 4096u;
+};
+
+inline ParallelSortSettings &parallel_sort_settings()
+{
+	static ParallelSortSettings settings;
+	return settings;
+}
+
+inline clever::TaskPool &parallel_sort_pool()
+{
+	static clever::TaskPool pool(parallel_sort_settings().threads);
+	return pool;
+}
+
+
+
+// sequential part of a sort: plain pointer and size for pingpong_merge_sort_by()
+template<typename T>
+struct SortedRun
+{
+	typedef T value_type;
+	T *d;
+	size_t n;
+};
+
+
+
+/*
+ * Merge path: the first k elements of merged [a, a+na) and [b, b+nb)
+ * consist of i elements of a and k-i of b. Returns i, equal elements
+ * are taken from a, as merge() does.
+ */
+template<typename T>
+size_t merge_path_split(T const *a, size_t na, T const *b, size_t nb, size_t k)
+{
+	size_t lo = k > nb ? k - nb : 0;
+	size_t hi = std::min(k, na);
+	while(lo < hi)
+	{
+		size_t const i = lo + (hi - lo) / 2;
+		if(b[k-i-1] < a[i])
+			hi = i;
+		else
+			lo = i + 1;
+	}
+	return lo;
+}
+
+
+
+/*
+ * Parallel merge: output is cut into equal pieces, a binary search
+ * on the merge path finds where every piece starts in both ranges,
+ * and pieces are merged independently by kernel_merge().
+ */
+template<typename T>
+void parallel_merge(
+	clever::TaskPool &pool, T const *fb, T const *fe, T const *sb, T const *se,
+	T *out, size_t cutoff
+)
+{
+	size_t const na = fe - fb, nb = se - sb, n = na + nb;
+	size_t const parts = std::min<size_t>(2 * pool.size(), n / cutoff);
+	if(parts < 2)
+	{
+		kernel_merge(fb, fe, sb, se, out);
+		return;
+	}
+
+	CLEVER_ZONE("parallel merge");
+	clever::TaskGroup group;
+	size_t i = 0, k = 0;
+	for(size_t p = 1; p <= parts; ++p)
+	{
+		size_t const nextk = n * p / parts;
+		size_t const nexti = merge_path_split(fb, na, sb, nb, nextk);
+		auto piece = [=] {
+			kernel_merge(fb + i, fb + nexti, sb + (k - i), sb + (nextk - nexti), out + k);
+		};
+		if(p < parts)
+			pool.spawn(group, piece);
+		else
+			piece();
+		i = nexti;
+		k = nextk;
+	}
+	pool.wait(group);
+	return;
+}
+
+
+
+/*
+ * Sorts [d, d+n) into d, or into s if toscratch; s is a free buffer
+ * of n elements. Halves are sorted into the other buffer as separate
+ * tasks, so every level merges between the buffers without copying.
+ */
+template<typename T>
+void parallel_sort_range(
+	clever::TaskPool &pool, T *d, T *s, size_t n, bool toscratch, size_t cutoff
+)
+{
+	if(n <= cutoff)
+	{
+		CLEVER_ZONE("sequential part");
+		SortedRun<T> run { d, n };
+		pingpong_merge_sort_by(run, &kernel_merge<T>);
+		if(toscratch)
+			std::copy(d, d + n, s);
+		return;
+	}
+
+	size_t const h = n / 2;
+	clever::TaskGroup group;
+	pool.spawn(group, [=, &pool] {
+		parallel_sort_range(pool, d, s, h, !toscratch, cutoff);
+	});
+	parallel_sort_range(pool, d + h, s + h, n - h, !toscratch, cutoff);
+	pool.wait(group);
+
+	T *const from = toscratch ? d : s;
+	T *const to = toscratch ? s : d;
+	parallel_merge(pool, from, from + h, from + h, from + n, to, cutoff);
+	return;
+}
+
+
+
+/*
+ * Parallel merge sort: recursion is split into tasks of the
+ * work-stealing pool down to the cutoff, where bottom-up merge
+ * sort with kernel_merge() takes over. Top levels are merged
+ * by parallel_merge(), so the last merges use all threads too.
+ */
+template<typename Array>
+void parallel_merge_sort(Array &ar)
+{
+	typedef typename Array::value_type value_type;
+	CLEVER_ZONE("parallel_merge_sort");
+
+	static thread_local std::vector<value_type> scratch;
+	if(scratch.size() < ar.n)
+		scratch.resize(ar.n);
+
+	size_t const cutoff = std::max<size_t>(1u, parallel_sort_settings().cutoff);
+	parallel_sort_range(parallel_sort_pool(), ar.d, scratch.data(), ar.n, false, cutoff);
+	return;
+}
+
+
+
+
+
+// end
+
+#endif
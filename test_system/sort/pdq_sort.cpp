@@ -0,0 +1,510 @@
+#ifndef PDQ_SORT_CPP
+#define PDQ_SORT_CPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#include <clever/Profiler.hpp>
+
+#include "../structures/random_array.cpp"
+#include "compare.cpp"
+
+
+
+
+
+/*
+ * Pattern-defeating quicksort (Orson Peters):
+ *
+ *         - short ranges by insertion sort
+ *         - pivot: median of 3, ninther for long ranges
+ *         - partition: BlockQuicksort for arithmetic types (comparisons
+ *           are written into offset buffers without branches, then
+ *           misplaced pairs are swapped), Hoare-like otherwise
+ *         - partition that swapped nothing: range may be sorted, try
+ *           insertion sort with a move limit
+ *         - pivot equal to the element before the range: all equal
+ *           elements go left and aren't touched anymore (duplicates)
+ *         - unbalanced partition: swaps break patterns; after log2(n)
+ *           of them the range goes to heapsort
+ *
+ * Generic version pdq_sort(first, last, comp, proj), see compare.cpp;
+ * block partition only for < on arithmetic types.
+ */
+constexpr size_t const PDQ_INSERTION_THRESHOLD = 24u;
+constexpr size_t const PDQ_NINTHER_THRESHOLD = 128u;
+constexpr size_t const PDQ_PARTIAL_INSERTION_LIMIT = 8u;
+constexpr size_t const PDQ_BLOCK = 64u;
+
+
+
+// insertion sort of [b, e)
+template<typename Iter, typename Compare = Less>
+constexpr void pdq_insertion_sort(Iter b, Iter e, Compare less = Compare())
+{
+	typedef typename std::iterator_traits<Iter>::value_type T;
+	if(b == e)
+		return;
+	for(Iter i = b+1; i != e; ++i)
+	{
+		if(!less(*i, *(i-1)))
+			continue;
+		T buf = std::move(*i);
+		Iter j = i;
+		do
+		{
+			*j = std::move(*(j-1));
+			--j;
+		}
+		while(j != b && less(buf, *(j-1)));
+		*j = std::move(buf);
+	}
+	return;
+}
+
+// the same, *(b-1) is not bigger than any element of [b, e)
+template<typename Iter, typename Compare>
+constexpr void pdq_unguarded_insertion_sort(Iter b, Iter e, Compare less)
+{
+	typedef typename std::iterator_traits<Iter>::value_type T;
+	if(b == e)
+		return;
+	for(Iter i = b+1; i != e; ++i)
+	{
+		if(!less(*i, *(i-1)))
+			continue;
+		T buf = std::move(*i);
+		Iter j = i;
+		do
+		{
+			*j = std::move(*(j-1));
+			--j;
+		}
+		while(less(buf, *(j-1)));
+		*j = std::move(buf);
+	}
+	return;
+}
+
+// insertion sort which gives up after PDQ_PARTIAL_INSERTION_LIMIT moves
+template<typename Iter, typename Compare>
+constexpr bool pdq_partial_insertion_sort(Iter b, Iter e, Compare less)
+{
+	typedef typename std::iterator_traits<Iter>::value_type T;
+	if(b == e)
+		return true;
+	size_t moves = 0;
+	for(Iter i = b+1; i != e; ++i)
+	{
+		if(!less(*i, *(i-1)))
+			continue;
+		T buf = std::move(*i);
+		Iter j = i;
+		do
+		{
+			*j = std::move(*(j-1));
+			--j;
+		}
+		while(j != b && less(buf, *(j-1)));
+		*j = std::move(buf);
+
+		moves += i - j;
+		if(moves > PDQ_PARTIAL_INSERTION_LIMIT)
+			return false;
+	}
+	return true;
+}
+
+
+
+template<typename Iter, typename Compare = Less>
+constexpr void pdq_sort2(Iter a, Iter b, Compare less = Compare())
+{
+	if(less(*b, *a))
+		sort_iter_swap(a, b);
+	return;
+}
+
+template<typename Iter, typename Compare = Less>
+constexpr void pdq_sort3(Iter a, Iter b, Iter c, Compare less = Compare())
+{
+	pdq_sort2(a, b, less);
+	pdq_sort2(b, c, less);
+	pdq_sort2(a, b, less);
+	return;
+}
+
+// std::make_heap and std::sort_heap aren't constexpr before C++20
+template<typename Iter, typename Compare>
+constexpr void pdq_sift_down(Iter b, size_t i, size_t n, Compare less)
+{
+	typedef typename std::iterator_traits<Iter>::value_type T;
+	T buf = std::move(b[i]);
+	for(size_t c; (c = 2*i + 1) < n; i = c)
+	{
+		if(c + 1 < n && less(b[c], b[c+1]))
+			++c;
+		if(!less(buf, b[c]))
+			break;
+		b[i] = std::move(b[c]);
+	}
+	b[i] = std::move(buf);
+	return;
+}
+
+template<typename Iter, typename Compare>
+constexpr void pdq_heap_sort(Iter b, Iter e, Compare less)
+{
+	size_t const n = e - b;
+	for(size_t i = n/2; i-- > 0;)
+		pdq_sift_down(b, i, n, less);
+	for(size_t i = n; i-- > 1;)
+	{
+		sort_iter_swap(b, b + i);
+		pdq_sift_down(b, 0, i, less);
+	}
+	return;
+}
+
+
+
+// swaps of misplaced pairs found by block partition
+template<typename Iter>
+constexpr void pdq_swap_offsets(
+	Iter first, Iter last,
+	unsigned char *offsetsl, unsigned char *offsetsr,
+	size_t num, bool useswaps
+)
+{
+	typedef typename std::iterator_traits<Iter>::value_type T;
+	if(useswaps)
+	{
+		// pairs are independent, swaps are faster
+		for(size_t i = 0; i < num; ++i)
+			sort_iter_swap(first + offsetsl[i], last - offsetsr[i]);
+	}
+	else if(num > 0)
+	{
+		// cyclic permutation, one move per element
+		Iter l = first + offsetsl[0];
+		Iter r = last - offsetsr[0];
+		T buf = std::move(*l);
+		*l = std::move(*r);
+		for(size_t i = 1; i < num; ++i)
+		{
+			l = first + offsetsl[i];
+			*r = std::move(*l);
+			r = last - offsetsr[i];
+			*l = std::move(*r);
+		}
+		*r = std::move(buf);
+	}
+	return;
+}
+
+
+
+/*
+ * Partitions [b, e) around the pivot *b: elements less than pivot
+ * go left, others right. Returns position of the pivot and whether
+ * the range was already partitioned. The caller guarantees that
+ * a median of 3 stands at b, so scans need no bounds checks
+ * at first.
+ */
+template<typename Iter, typename Compare>
+constexpr std::pair<Iter, bool> pdq_partition_right_branchless(Iter b, Iter e, Compare less)
+{
+	typedef typename std::iterator_traits<Iter>::value_type T;
+	T pivot(std::move(*b));
+	Iter first = b;
+	Iter last = e;
+
+	while(less(*++first, pivot));
+	if(first - 1 == b)
+		while(first < last && !less(*--last, pivot));
+	else
+		while(!less(*--last, pivot));
+
+	bool const partitioned = first >= last;
+	if(!partitioned)
+	{
+		sort_iter_swap(first, last);
+		++first;
+
+		// offsets of misplaced elements from the bases: left ones
+		// from offsetsbasel forward, right ones from offsetsbaser back
+		alignas(64) unsigned char offsetslbuf[PDQ_BLOCK] = {};
+		alignas(64) unsigned char offsetsrbuf[PDQ_BLOCK] = {};
+		unsigned char *offsetsl = offsetslbuf, *offsetsr = offsetsrbuf;
+		Iter offsetsbasel = first, offsetsbaser = last;
+		size_t numl = 0, numr = 0, startl = 0, startr = 0;
+
+		while(first < last)
+		{
+			// empty blocks take up to PDQ_BLOCK unknown elements
+			size_t const unknown = last - first;
+			size_t const splitl = numl == 0 ? (numr == 0 ? unknown / 2 : unknown) : 0;
+			size_t const splitr = numr == 0 ? unknown - splitl : 0;
+
+			size_t const sizel = std::min(splitl, PDQ_BLOCK);
+			for(size_t i = 0; i < sizel;)
+			{
+				offsetsl[numl] = (unsigned char)i++;
+				numl += !less(*first, pivot);
+				++first;
+			}
+			size_t const sizer = std::min(splitr, PDQ_BLOCK);
+			for(size_t i = 0; i < sizer;)
+			{
+				offsetsr[numr] = (unsigned char)++i;
+				numr += less(*--last, pivot);
+			}
+
+			size_t const num = std::min(numl, numr);
+			pdq_swap_offsets(
+				offsetsbasel, offsetsbaser, offsetsl + startl, offsetsr + startr,
+				num, numl == numr
+			);
+			numl -= num;
+			numr -= num;
+			startl += num;
+			startr += num;
+			if(numl == 0)
+			{
+				startl = 0;
+				offsetsbasel = first;
+			}
+			if(numr == 0)
+			{
+				startr = 0;
+				offsetsbaser = last;
+			}
+		}
+
+		// one side is known, move its leftovers to the boundary
+		if(numl)
+		{
+			offsetsl += startl;
+			while(numl--)
+				sort_iter_swap(offsetsbasel + offsetsl[numl], --last);
+			first = last;
+		}
+		if(numr)
+		{
+			offsetsr += startr;
+			while(numr--)
+			{
+				sort_iter_swap(offsetsbaser - offsetsr[numr], first);
+				++first;
+			}
+			last = first;
+		}
+	}
+
+	Iter const pivotpos = first - 1;
+	*b = std::move(*pivotpos);
+	*pivotpos = std::move(pivot);
+	return { pivotpos, partitioned };
+}
+
+// the same with a branch per element
+template<typename Iter, typename Compare>
+constexpr std::pair<Iter, bool> pdq_partition_right(Iter b, Iter e, Compare less)
+{
+	typedef typename std::iterator_traits<Iter>::value_type T;
+	T pivot(std::move(*b));
+	Iter first = b;
+	Iter last = e;
+
+	while(less(*++first, pivot));
+	if(first - 1 == b)
+		while(first < last && !less(*--last, pivot));
+	else
+		while(!less(*--last, pivot));
+
+	bool const partitioned = first >= last;
+	while(first < last)
+	{
+		sort_iter_swap(first, last);
+		while(less(*++first, pivot));
+		while(!less(*--last, pivot));
+	}
+
+	Iter const pivotpos = first - 1;
+	*b = std::move(*pivotpos);
+	*pivotpos = std::move(pivot);
+	return { pivotpos, partitioned };
+}
+
+// elements equal to pivot *b go left, used when there are many of them
+template<typename Iter, typename Compare>
+constexpr Iter pdq_partition_left(Iter b, Iter e, Compare less)
+{
+	typedef typename std::iterator_traits<Iter>::value_type T;
+	T pivot(std::move(*b));
+	Iter first = b;
+	Iter last = e;
+
+	while(less(pivot, *--last));
+	if(last + 1 == e)
+		while(first < last && !less(pivot, *++first));
+	else
+		while(!less(pivot, *++first));
+
+	while(first < last)
+	{
+		sort_iter_swap(first, last);
+		while(less(pivot, *--last));
+		while(!less(pivot, *++first));
+	}
+
+	Iter const pivotpos = last;
+	*b = std::move(*pivotpos);
+	*pivotpos = std::move(pivot);
+	return pivotpos;
+}
+
+
+
+template<bool Branchless, typename Iter, typename Compare>
+constexpr void pdq_sort_loop(Iter b, Iter e, Compare less, int badallowed, bool leftmost = true)
+{
+	for(;;)
+	{
+		size_t const size = e - b;
+		if(size < PDQ_INSERTION_THRESHOLD)
+		{
+			if(leftmost)
+				pdq_insertion_sort(b, e, less);
+			else
+				pdq_unguarded_insertion_sort(b, e, less);
+			return;
+		}
+
+		// pivot to b
+		size_t const half = size / 2;
+		if(size > PDQ_NINTHER_THRESHOLD)
+		{
+			pdq_sort3(b, b + half, e - 1, less);
+			pdq_sort3(b + 1, b + (half - 1), e - 2, less);
+			pdq_sort3(b + 2, b + (half + 1), e - 3, less);
+			pdq_sort3(b + (half - 1), b + half, b + (half + 1), less);
+			sort_iter_swap(b, b + half);
+		}
+		else
+		{
+			pdq_sort3(b + half, b, e - 1, less);
+		}
+
+		// element before the range is not less than pivot: pivot is
+		// the smallest, equal elements are done
+		if(!leftmost && !less(*(b - 1), *b))
+		{
+			b = pdq_partition_left(b, e, less) + 1;
+			continue;
+		}
+
+		std::pair<Iter, bool> const part = Branchless ?
+			pdq_partition_right_branchless(b, e, less) :
+			pdq_partition_right(b, e, less);
+		Iter const pivotpos = part.first;
+		size_t const lsize = pivotpos - b;
+		size_t const rsize = e - (pivotpos + 1);
+
+		if(lsize < size / 8 || rsize < size / 8)
+		{
+			// bad partition: too many of them, give up on quicksort
+			if(--badallowed == 0)
+			{
+				pdq_heap_sort(b, e, less);
+				return;
+			}
+
+			// break patterns by swaps at fixed positions
+			if(lsize >= PDQ_INSERTION_THRESHOLD)
+			{
+				sort_iter_swap(b, b + lsize / 4);
+				sort_iter_swap(pivotpos - 1, pivotpos - lsize / 4);
+				if(lsize > PDQ_NINTHER_THRESHOLD)
+				{
+					sort_iter_swap(b + 1, b + (lsize / 4 + 1));
+					sort_iter_swap(b + 2, b + (lsize / 4 + 2));
+					sort_iter_swap(pivotpos - 2, pivotpos - (lsize / 4 + 1));
+					sort_iter_swap(pivotpos - 3, pivotpos - (lsize / 4 + 2));
+				}
+			}
+			if(rsize >= PDQ_INSERTION_THRESHOLD)
+			{
+				sort_iter_swap(pivotpos + 1, pivotpos + (1 + rsize / 4));
+				sort_iter_swap(e - 1, e - rsize / 4);
+				if(rsize > PDQ_NINTHER_THRESHOLD)
+				{
+					sort_iter_swap(pivotpos + 2, pivotpos + (2 + rsize / 4));
+					sort_iter_swap(pivotpos + 3, pivotpos + (3 + rsize / 4));
+					sort_iter_swap(e - 2, e - (1 + rsize / 4));
+					sort_iter_swap(e - 3, e - (2 + rsize / 4));
+				}
+			}
+		}
+		else if(
+			part.second &&
+			pdq_partial_insertion_sort(b, pivotpos, less) &&
+			pdq_partial_insertion_sort(pivotpos + 1, e, less)
+		) {
+			// nothing was swapped and both sides are (almost) sorted
+			return;
+		}
+
+		// left side by recursion, right one by the loop
+		pdq_sort_loop<Branchless>(b, pivotpos, less, badallowed, leftmost);
+		b = pivotpos + 1;
+		leftmost = false;
+	}
+}
+
+// generic version, see compare.cpp
+template<typename Iter, typename Compare = Less, typename Projection = Identity>
+constexpr void pdq_sort(Iter b, Iter e, Compare comp = Compare(), Projection proj = Projection())
+{
+	typedef typename std::iterator_traits<Iter>::value_type T;
+	auto const less = make_compare(comp, proj);
+
+	if(e - b < 2)
+		return;
+	int badallowed = 0;
+	for(size_t n = e - b; n > 1; n /= 2)
+		++badallowed;
+	pdq_sort_loop<is_default_compare<decltype(less), T>()>(b, e, less, badallowed);
+	return;
+}
+
+
+
+template<typename Array>
+void pdq_sort(Array &ar)
+{
+	CLEVER_ZONE("pdq_sort");
+	pdq_sort(ar.d, ar.d + ar.n);
+	return;
+}
+
+// comparator through a pointer, see FunctionCompare in compare.cpp
+template<typename Array>
+void pdq_sort_function_compare(Array &ar)
+{
+	CLEVER_ZONE("pdq_sort_function_compare");
+	typedef typename Array::value_type value_type;
+	pdq_sort(ar.d, ar.d + ar.n, FunctionCompare<value_type>{ function_less<value_type> });
+	return;
+}
+
+
+
+
+
+// end
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef PINGPONG_MERGE_SORT_CPP
+#define PINGPONG_MERGE_SORT_CPP
+
+#include <algorithm>
+#include <vector>
+
+#include <clever/Profiler.hpp>
+
+#include "../structures/random_array.cpp"
+#include "merge_sort.cpp"
+
+
+
+
+
+// size of blocks sorted by insertion before merging
+constexpr unsigned int const PINGPONG_BLOCK = 16u;
+
+
+
+// insertion sort of [b, e)
+template<typename T>
+void pingpong_insertion(T *b, T *e)
+{
+	for(T *i = b+1; i < e; ++i)
+	{
+		T buf = *i;
+		T *j = i;
+		for(; j > b && buf < *(j-1); --j)
+			*j = *(j-1);
+		*j = buf;
+	}
+	return;
+}
+
+
+
+/*
+ * bottom-up merge sort: every level merges runs from one buffer
+ * into the other, so each element is written once per level and
+ * nothing is copied back. Number of levels is known in advance;
+ * if it's odd, base blocks are sorted into the scratch buffer,
+ * so the last level writes into the array itself.
+ * Scratch buffer lives between calls (one per thread and type).
+ *
+ * merge_runs(fb, fe, sb, se, out) is the merge step, merge() by default.
+ */
+template<typename Array, typename Merge>
+void pingpong_merge_sort_by(Array &ar, Merge merge_runs)
+{
+	typedef typename Array::value_type value_type;
+
+	size_t const n = ar.n;
+	if(n < 2)
+		return;
+
+	static thread_local std::vector<value_type> scratch;
+	if(scratch.size() < n)
+		scratch.resize(n);
+
+	unsigned int levels = 0;
+	for(size_t width = PINGPONG_BLOCK; width < n; width *= 2)
+		++levels;
+
+	value_type *src = ar.d;
+	value_type *dst = scratch.data();
+	if(levels % 2)
+		std::swap(src, dst);
+
+
+	// base blocks
+	{
+		CLEVER_ZONE("base blocks");
+		for(size_t b = 0; b < n; b += PINGPONG_BLOCK)
+		{
+			size_t const e = std::min<size_t>(n, b + PINGPONG_BLOCK);
+			if(src != ar.d)
+				std::copy(ar.d+b, ar.d+e, src+b);
+			pingpong_insertion(src+b, src+e);
+		}
+	}
+
+	// levels
+	for(size_t width = PINGPONG_BLOCK; width < n; width *= 2)
+	{
+		CLEVER_ZONE("merge level");
+		for(size_t b = 0; b < n; b += 2*width)
+		{
+			size_t const m = std::min(n, b + width);
+			size_t const e = std::min(n, b + 2*width);
+			merge_runs(src+b, src+m, src+m, src+e, dst+b);
+		}
+		std::swap(src, dst);
+	}
+
+	return;
+}
+
+template<typename Array>
+void pingpong_merge_sort(Array &ar)
+{
+	CLEVER_ZONE("pingpong_merge_sort");
+	pingpong_merge_sort_by(ar, &merge<typename Array::value_type *>);
+	return;
+}
+
+
+
+
+
+// end
+
+#endif
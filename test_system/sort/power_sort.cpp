@@ -0,0 +1,430 @@
+#ifndef POWER_SORT_CPP
+#define POWER_SORT_CPP
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <clever/Profiler.hpp>
+
+#include "../structures/random_array.cpp"
+#include "compare.cpp"
+
+
+
+
+
+/*
+ * Adaptive natural merge sort, Timsort with powersort merge policy
+ * (Munro, Wild):
+ *
+ *         - runs are found as they are: non-descending ones, and
+ *           strictly descending ones which are reversed (stability)
+ *         - a short run is extended to the minimal length (32..64)
+ *           by binary insertion sort
+ *         - power of the boundary between two runs is the first bit
+ *           where binary fractions of their midpoints (of n) differ;
+ *           runs on the stack are merged while the power under the top
+ *           is bigger than the new one, so merges are nearly balanced
+ *           and sorted input costs n-1 comparisons
+ *         - merge: parts which are already in place are cut off by
+ *           galloping, the shorter run goes to the buffer; after
+ *           POWERSORT_MIN_GALLOP wins in a row of one run the merge
+ *           gallops (exponential search), the threshold adapts to data
+ *
+ * Buffer is n/2 elements at most. Generic version
+ * power_sort(first, last, comp, proj), see compare.cpp.
+ */
+constexpr size_t const POWERSORT_MIN_GALLOP = 7u;
+constexpr size_t const POWERSORT_MAX_MINRUN = 64u;
+
+
+
+// length of array pieces sorted by binary insertion: n / 2^k in [32, 64]
+inline size_t powersort_minrun(size_t n)
+{
+	size_t low = 0;
+	while(n >= POWERSORT_MAX_MINRUN)
+	{
+		low |= n & 1;
+		n >>= 1;
+	}
+	return n + low;
+}
+
+// elements [b, i) are sorted, [i, e) are inserted by binary search
+template<typename Iter, typename Compare>
+void powersort_binary_insertion(Iter b, Iter i, Iter e, Compare less)
+{
+	for(; i != e; ++i)
+	{
+		Iter const pos = std::upper_bound(b, i, *i, less);
+		if(pos == i)
+			continue;
+		typename std::iterator_traits<Iter>::value_type buf = std::move(*i);
+		std::move_backward(pos, i, i+1);
+		*pos = std::move(buf);
+	}
+	return;
+}
+
+// length of the run at b, descending run is reversed
+template<typename Iter, typename Compare>
+size_t powersort_count_run(Iter b, Iter e, Compare less)
+{
+	Iter i = b+1;
+	if(i == e)
+		return 1;
+	if(less(*i, *b))
+	{
+		while(++i != e && less(*i, *(i-1)));
+		std::reverse(b, i);
+	}
+	else
+	{
+		while(++i != e && !less(*i, *(i-1)));
+	}
+	return i - b;
+}
+
+// power of the boundary of runs [s1, s1+n1) and [s1+n1, s1+n1+n2)
+inline unsigned int powersort_power(size_t s1, size_t n1, size_t n2, size_t n)
+{
+	// doubled midpoints, bits of a/n and b/n one by one
+	size_t a = 2*s1 + n1, b = a + n1 + n2;
+	unsigned int power = 0;
+	while(true)
+	{
+		++power;
+		if(a >= n)
+		{
+			a -= n;
+			b -= n;
+		}
+		else if(b >= n)
+			break;
+		a <<= 1;
+		b <<= 1;
+	}
+	return power;
+}
+
+
+
+/*
+ * Galloping searches in sorted [a, a+n): number of elements which go
+ * before key (Upper: not greater than key, otherwise less than key).
+ * Exponential search from the start or from the end, then binary search
+ * in the last step, so k elements cost O(log k) comparisons.
+ */
+template<bool Upper, typename T, typename Iter, typename Compare>
+size_t powersort_gallop_forward(T const &key, Iter a, size_t n, Compare less)
+{
+	auto before = [&key, &less](T const &x) { return Upper ? !less(key, x) : less(x, key); };
+	size_t lo = 0, hi = 1;
+	while(hi <= n && before(a[hi-1]))
+	{
+		lo = hi;
+		hi = 2*hi + 1;
+	}
+	hi = std::min(hi, n);
+	return std::partition_point(a + lo, a + hi, before) - a;
+}
+
+template<bool Upper, typename T, typename Iter, typename Compare>
+size_t powersort_gallop_backward(T const &key, Iter a, size_t n, Compare less)
+{
+	auto before = [&key, &less](T const &x) { return Upper ? !less(key, x) : less(x, key); };
+	size_t lo = 0, hi = n;
+	for(size_t ofs = 1; ofs <= hi; ofs *= 2)
+	{
+		if(before(a[hi - ofs]))
+		{
+			lo = hi - ofs + 1;
+			break;
+		}
+		hi -= ofs;
+	}
+	return std::partition_point(a + lo, a + hi, before) - a;
+}
+
+
+
+/*
+ * Merges of neighbouring runs a and b = a+na, after the cut:
+ * a[0] > b[0] and a[na-1] > b[nb-1]. merge_lo copies a to the buffer
+ * and merges from the start, merge_hi copies b and merges from the end.
+ */
+template<typename Iter, typename Buf, typename Compare>
+void powersort_merge_lo(Iter a, size_t na, size_t nb, Buf buf, size_t &mingallop, Compare less)
+{
+	std::copy(a, a + na, buf);
+	Buf l = buf;
+	Buf const le = buf + na;
+	Iter r = a + na;
+	Iter const re = r + nb;
+	Iter dst = a;
+
+	*dst++ = *r++;
+	if(r == re)
+		goto done;
+
+	while(true)
+	{
+		size_t lwins = 0, rwins = 0;
+		// one by one, equal elements from the first run
+		do
+		{
+			if(less(*r, *l))
+			{
+				*dst++ = *r++;
+				++rwins;
+				lwins = 0;
+				if(r == re)
+					goto done;
+			}
+			else
+			{
+				*dst++ = *l++;
+				++lwins;
+				rwins = 0;
+				if(l == le)
+					goto done;
+			}
+		}
+		while((lwins | rwins) < mingallop);
+
+		// galloping while it moves long pieces
+		++mingallop;
+		do
+		{
+			mingallop -= mingallop > 1;
+
+			lwins = powersort_gallop_forward<true>(*r, l, le - l, less);
+			dst = std::copy(l, l + lwins, dst);
+			l += lwins;
+			if(l == le)
+				goto done;
+			*dst++ = *r++;
+			if(r == re)
+				goto done;
+
+			rwins = powersort_gallop_forward<false>(*l, r, re - r, less);
+			dst = std::copy(r, r + rwins, dst);
+			r += rwins;
+			if(r == re)
+				goto done;
+			*dst++ = *l++;
+			if(l == le)
+				goto done;
+		}
+		while(lwins >= POWERSORT_MIN_GALLOP || rwins >= POWERSORT_MIN_GALLOP);
+		++mingallop;
+	}
+
+done:
+	// rest of the second run is in place already
+	std::copy(l, le, dst);
+	return;
+}
+
+template<typename Iter, typename Buf, typename Compare>
+void powersort_merge_hi(Iter a, size_t na, size_t nb, Buf buf, size_t &mingallop, Compare less)
+{
+	std::copy(a + na, a + na + nb, buf);
+	Iter const lb = a;
+	Iter l = a + na;
+	Buf const rb = buf;
+	Buf r = buf + nb;
+	Iter dst = a + na + nb;
+
+	*--dst = *--l;
+	if(l == lb)
+		goto done;
+
+	while(true)
+	{
+		size_t lwins = 0, rwins = 0;
+		// one by one from the end, equal elements from the second run
+		do
+		{
+			if(less(*(r-1), *(l-1)))
+			{
+				*--dst = *--l;
+				++lwins;
+				rwins = 0;
+				if(l == lb)
+					goto done;
+			}
+			else
+			{
+				*--dst = *--r;
+				++rwins;
+				lwins = 0;
+				if(r == rb)
+					goto done;
+			}
+		}
+		while((lwins | rwins) < mingallop);
+
+		++mingallop;
+		do
+		{
+			mingallop -= mingallop > 1;
+
+			lwins = (l - lb) - powersort_gallop_backward<true>(*(r-1), lb, l - lb, less);
+			dst = std::copy_backward(l - lwins, l, dst);
+			l -= lwins;
+			if(l == lb)
+				goto done;
+			*--dst = *--r;
+			if(r == rb)
+				goto done;
+
+			rwins = (r - rb) - powersort_gallop_backward<false>(*(l-1), rb, r - rb, less);
+			dst = std::copy_backward(r - rwins, r, dst);
+			r -= rwins;
+			if(r == rb)
+				goto done;
+			*--dst = *--l;
+			if(l == lb)
+				goto done;
+		}
+		while(lwins >= POWERSORT_MIN_GALLOP || rwins >= POWERSORT_MIN_GALLOP);
+		++mingallop;
+	}
+
+done:
+	// rest of the first run is in place already
+	std::copy_backward(rb, r, dst);
+	return;
+}
+
+// merge of sorted [a, a+na) and [a+na, a+na+nb)
+template<typename Iter, typename Buf, typename Compare>
+void powersort_merge(Iter a, size_t na, size_t nb, Buf buf, size_t &mingallop, Compare less)
+{
+	CLEVER_ZONE("merge");
+
+	// start of the first run and end of the second stay where they are
+	size_t const k = powersort_gallop_forward<true>(a[na], a, na, less);
+	a += k;
+	na -= k;
+	if(na == 0)
+		return;
+	nb = powersort_gallop_backward<false>(a[na-1], a + na, nb, less);
+	if(nb == 0)
+		return;
+
+	if(na <= nb)
+		powersort_merge_lo(a, na, nb, buf, mingallop, less);
+	else
+		powersort_merge_hi(a, na, nb, buf, mingallop, less);
+	return;
+}
+
+
+
+// buf has n/2 elements
+template<typename Iter, typename Buf, typename Compare>
+void power_sort_buffered(Iter d, size_t n, Buf buf, Compare less)
+{
+	struct Run
+	{
+		size_t begin, n;
+		unsigned int power;
+	};
+
+	if(n < 2)
+		return;
+
+	size_t const minrun = powersort_minrun(n);
+	size_t mingallop = POWERSORT_MIN_GALLOP;
+	std::vector<Run> stack;
+
+	auto merge_top = [&]() {
+		Run &first = stack[stack.size()-2];
+		Run const &second = stack.back();
+		powersort_merge(d + first.begin, first.n, second.n, buf, mingallop, less);
+		first.n += second.n;
+		stack.pop_back();
+		return;
+	};
+
+	for(size_t begin = 0; begin < n;)
+	{
+		size_t len;
+		{
+			CLEVER_ZONE("runs");
+			len = powersort_count_run(d + begin, d + n, less);
+			if(len < minrun)
+			{
+				size_t const extended = std::min(minrun, n - begin);
+				powersort_binary_insertion(d + begin, d + begin + len, d + begin + extended, less);
+				len = extended;
+			}
+		}
+
+		if(!stack.empty())
+		{
+			Run const &top = stack.back();
+			unsigned int const power = powersort_power(top.begin, top.n, len, n);
+			while(stack.size() > 1 && stack[stack.size()-2].power > power)
+				merge_top();
+			stack.back().power = power;
+		}
+		stack.push_back({begin, len, 0});
+		begin += len;
+	}
+
+	while(stack.size() > 1)
+		merge_top();
+	return;
+}
+
+
+// generic version, see compare.cpp
+template<typename Iter, typename Compare = Less, typename Projection = Identity>
+void power_sort(Iter b, Iter e, Compare comp = Compare(), Projection proj = Projection())
+{
+	std::vector<typename std::iterator_traits<Iter>::value_type> buf((e - b)/2);
+	power_sort_buffered(b, e - b, buf.begin(), make_compare(comp, proj));
+	return;
+}
+
+
+template<typename Array>
+void power_sort(Array &ar)
+{
+	CLEVER_ZONE("power_sort");
+	static thread_local std::vector<typename Array::value_type> scratch;
+	if(scratch.size() < ar.n/2)
+		scratch.resize(ar.n/2);
+	power_sort_buffered(ar.d, ar.n, scratch.data(), Less());
+	return;
+}
+
+// comparator through a pointer, see FunctionCompare in compare.cpp
+template<typename Array>
+void power_sort_function_compare(Array &ar)
+{
+	CLEVER_ZONE("power_sort_function_compare");
+	typedef typename Array::value_type value_type;
+	static thread_local std::vector<value_type> scratch;
+	if(scratch.size() < ar.n/2)
+		scratch.resize(ar.n/2);
+	power_sort_buffered(
+		ar.d, ar.n, scratch.data(), FunctionCompare<value_type>{ function_less<value_type> }
+	);
+	return;
+}
+
+
+
+
+
+// end
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef RADIX_SORT_CPP
+#define RADIX_SORT_CPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <clever/Profiler.hpp>
+
+#include "../structures/random_array.cpp"
+
+
+
+
+
+/*
+ * Radix key of an element: unsigned integer ordered as elements are.
+ *
+ *         unsigned integers       - as is
+ *         signed integers         - sign bit flipped
+ *         IEEE floats             - negative: all bits flipped,
+ *                                   positive: sign bit set
+ *         records (.key member)   - radix key of the key
+ *         traced values (.load()) - radix key of the loaded value
+ *
+ * -0.0 goes before 0.0, NaNs go to the ends by their sign.
+ */
+template<typename T, typename = void>
+struct RadixKey;
+
+template<typename T>
+struct RadixKey<T, typename std::enable_if<std::is_integral<T>::value>::type>
+{
+	typedef typename std::make_unsigned<T>::type type;
+
+	static type get(T value)
+	{
+		type const sign = std::is_signed<T>::value ?
+			type(1) << (sizeof(T)*8 - 1) : type(0);
+		return type(value) ^ sign;
+	}
+};
+
+template<typename T>
+struct RadixKey<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+	static_assert(sizeof(T) == 4 || sizeof(T) == 8, "IEEE float or double");
+	typedef typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type type;
+
+	static type get(T value)
+	{
+		type bits;
+		std::memcpy(&bits, &value, sizeof bits);
+		type const sign = type(1) << (sizeof(T)*8 - 1);
+		return bits & sign ? ~bits : bits | sign;
+	}
+};
+
+template<typename T>
+struct RadixKey<T, std::void_t<decltype(std::declval<T const &>().key)>>
+{
+	typedef decltype(std::declval<T const &>().key) key_type;
+	typedef typename RadixKey<key_type>::type type;
+
+	static type get(T const &value)
+	{
+		return RadixKey<key_type>::get(value.key);
+	}
+};
+
+template<typename T>
+struct RadixKey<T, std::void_t<decltype(std::declval<T const &>().load())>>
+{
+	typedef decltype(std::declval<T const &>().load()) value_type;
+	typedef typename RadixKey<value_type>::type type;
+
+	static type get(T const &value)
+	{
+		return RadixKey<value_type>::get(value.load());
+	}
+};
+
+
+
+/*
+ * LSD radix sort with digits of Bits bits, from the lowest one.
+ * One counting pass builds histograms of all digits at once, then
+ * every digit is a stable scatter between the array and the buffer.
+ * A digit equal in all keys (high bytes of small numbers) would move
+ * nothing and is skipped. After an odd number of scatters the result
+ * is copied back. Arrays up to 2^32-1 elements.
+ */
+template<unsigned int Bits, typename T>
+void radix_sort(T *d, size_t n, T *buf)
+{
+	typedef RadixKey<T> radix_key;
+	typedef typename radix_key::type key_type;
+	typedef uint32_t count_type;
+
+	constexpr unsigned int const DIGITS = (sizeof(key_type)*8 + Bits - 1) / Bits;
+	constexpr size_t const RADIX = size_t(1) << Bits;
+	constexpr key_type const MASK = key_type(RADIX - 1);
+
+	if(n < 2)
+		return;
+
+	static thread_local std::vector<count_type> counts;
+	counts.assign(DIGITS * RADIX, 0);
+
+	{
+		CLEVER_ZONE("histograms");
+		for(size_t i = 0; i < n; ++i)
+		{
+			key_type const key = radix_key::get(d[i]);
+			for(unsigned int digit = 0; digit < DIGITS; ++digit)
+				++counts[digit*RADIX + ((key >> (digit*Bits)) & MASK)];
+		}
+	}
+
+	T *src = d, *dst = buf;
+	for(unsigned int digit = 0; digit < DIGITS; ++digit)
+	{
+		unsigned int const shift = digit * Bits;
+		count_type *const count = counts.data() + digit*RADIX;
+		if(count[(radix_key::get(src[0]) >> shift) & MASK] == n)
+			continue;
+
+		CLEVER_ZONE("scatter");
+		count_type sum = 0;
+		for(size_t b = 0; b < RADIX; ++b)
+		{
+			count_type const c = count[b];
+			count[b] = sum;
+			sum += c;
+		}
+		for(size_t i = 0; i < n; ++i)
+			dst[count[(radix_key::get(src[i]) >> shift) & MASK]++] = src[i];
+		std::swap(src, dst);
+	}
+
+	if(src != d)
+		std::copy(src, src + n, d);
+	return;
+}
+
+template<unsigned int Bits, typename Array>
+void radix_sort_by(Array &ar)
+{
+	static thread_local std::vector<typename Array::value_type> scratch;
+	if(scratch.size() < ar.n)
+		scratch.resize(ar.n);
+	radix_sort<Bits>(ar.d, ar.n, scratch.data());
+	return;
+}
+
+
+
+// bytes: 4 passes for 32-bit keys, 8 for 64-bit, 256 counters each
+template<typename Array>
+void radix_sort(Array &ar)
+{
+	CLEVER_ZONE("radix_sort");
+	radix_sort_by<8>(ar);
+	return;
+}
+
+// 11-bit digits: 3 passes for 32-bit keys, 6 for 64-bit, 2048 counters each
+template<typename Array>
+void radix11_sort(Array &ar)
+{
+	CLEVER_ZONE("radix11_sort");
+	radix_sort_by<11>(ar);
+	return;
+}
+
+
+
+
+
+// end
+
+#endif
@@ -0,0 +1,445 @@
+#ifndef SAMPLE_SORT_CPP
+#define SAMPLE_SORT_CPP
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <clever/Profiler.hpp>
+#include <clever/Random.hpp>
+#include <clever/TaskPool.hpp>
+
+#include "../structures/random_array.cpp"
+#include "parallel_merge_sort.cpp"
+#include "pdq_sort.cpp"
+
+
+
+
+
+/*
+ * In-place parallel samplesort (IPS4o, Axtmann et al.), one level:
+ *
+ *         1. sampling: splitters are picked from a sorted random sample
+ *         2. local classification: every thread scans its stripe of the
+ *            array, elements go to per-bucket buffers of one block,
+ *            full buffers are written back to the stripe start
+ *         3. full blocks are moved to the array start, bucket sizes
+ *            are known from counters, bucket areas are aligned to blocks
+ *         4. block permutation: threads take blocks from bucket areas
+ *            and swap them to the write position of their bucket until
+ *            every block is in its bucket area
+ *         5. cleanup: ends of buckets which don't fill whole blocks are
+ *            filled from the buffers and from blocks crossing the bucket
+ *            boundary
+ *
+ * Then buckets are sorted as tasks of the pool, small ones by pdq_sort.
+ * Extra memory is buffers of threads * buckets * block elements,
+ * independent of N.
+ *
+ * Buckets of elements equal to a splitter are separate and not sorted
+ * further, so duplicates end the recursion. Ranges up to base elements
+ * (parallel_sort_settings().samplebase) go to pdq_sort.
+ */
+constexpr unsigned int const SAMPLESORT_LOG_BUCKETS = 7u;
+constexpr size_t const SAMPLESORT_BLOCK_BYTES = 1024u;
+constexpr size_t const SAMPLESORT_OVERSAMPLING = 16u;
+
+template<typename T>
+constexpr size_t samplesort_block()
+{
+	return std::max<size_t>(1u, SAMPLESORT_BLOCK_BYTES / sizeof(T));
+}
+
+
+
+/*
+ * Branchless classification: k-1 splitters in a search tree stored
+ * as an array (children of i are 2i and 2i+1), every level is one
+ * comparison and index arithmetic. Bucket 2j holds elements between
+ * splitters j-1 and j, bucket 2j+1 elements equal to splitter j.
+ */
+template<typename T>
+class SampleClassifier
+{
+public:
+	SampleClassifier(T const *sample, size_t samplesize, unsigned int logk):
+		logk_(logk), k_(size_t(1) << logk), tree_(k_), splitters_(k_)
+	{
+		size_t const step = samplesize / k_;
+		for(size_t i = 0; i + 1 < k_; ++i)
+			splitters_[i] = sample[(i+1)*step];
+		splitters_[k_-1] = splitters_[k_-2];
+
+		size_t pos = 0;
+		build_(1, pos);
+		return;
+	}
+
+	size_t buckets() const
+	{
+		return 2*k_;
+	}
+
+	size_t classify(T const &value) const
+	{
+		size_t i = 1;
+		for(unsigned int level = 0; level < logk_; ++level)
+			i = 2*i + (tree_[i] < value);
+		size_t const j = i - k_;
+		return 2*j + ((j + 1 != k_) & !(value < splitters_[j]));
+	}
+
+private:
+	// in-order walk of the tree takes splitters in sorted order
+	void build_(size_t node, size_t &pos)
+	{
+		if(node >= k_)
+			return;
+		build_(2*node, pos);
+		tree_[node] = splitters_[pos++];
+		build_(2*node + 1, pos);
+		return;
+	}
+
+
+
+	unsigned int logk_;
+	size_t k_;
+	std::vector<T> tree_;
+	std::vector<T> splitters_;
+
+};
+
+
+
+template<typename T>
+class SampleSortLevel
+{
+public:
+	static constexpr size_t const B = samplesort_block<T>();
+
+	SampleSortLevel(
+		clever::TaskPool &pool, T *d, size_t n, unsigned int threads,
+		SampleClassifier<T> const &classifier
+	):
+		pool_(pool), d_(d), n_(n), threads_(threads), cls_(classifier),
+		nb_(classifier.buckets()),
+		buffers_(threads * nb_ * B), fills_(threads * nb_),
+		counts_(threads * nb_), full_(threads),
+		bounds_(nb_ + 1), write_(nb_), read_(nb_), locks_(new std::mutex[nb_]),
+		swap_(threads * 2 * B), overflow_(B)
+	{
+		return;
+	}
+
+	// bucket boundaries, nb_ + 1 of them
+	std::vector<size_t> const &partition()
+	{
+		stripe_ = (n_ + threads_ - 1) / threads_;
+		stripe_ = (stripe_ + B - 1) / B * B;
+
+		parallel_([this](unsigned int t) { classify_(t); });
+		bounds_and_blocks_();
+		parallel_([this](unsigned int t) { permute_(t); });
+		cleanup_();
+		return bounds_;
+	}
+
+private:
+	template<typename Function>
+	void parallel_(Function f)
+	{
+		clever::TaskGroup group;
+		for(unsigned int t = 1; t < threads_; ++t)
+			pool_.spawn(group, [f, t] { f(t); });
+		f(0);
+		pool_.wait(group);
+		return;
+	}
+
+	static size_t roundup_(size_t x)
+	{
+		return (x + B - 1) / B * B;
+	}
+
+
+
+	void classify_(unsigned int t)
+	{
+		CLEVER_ZONE("local classification");
+		T *const buffers = buffers_.data() + t*nb_*B;
+		size_t *const fills = fills_.data() + t*nb_;
+		size_t *const counts = counts_.data() + t*nb_;
+
+		T *const b = d_ + std::min(n_, t*stripe_);
+		T *const e = d_ + std::min(n_, (t+1)*stripe_);
+		T *write = b;
+		for(T *it = b; it != e; ++it)
+		{
+			size_t const bucket = cls_.classify(*it);
+			T *const buffer = buffers + bucket*B;
+			if(fills[bucket] == B)
+			{
+				std::copy(buffer, buffer + B, write);
+				write += B;
+				fills[bucket] = 0;
+			}
+			buffer[fills[bucket]++] = *it;
+			++counts[bucket];
+		}
+		full_[t] = (write - b) / B;
+		return;
+	}
+
+	void bounds_and_blocks_()
+	{
+		CLEVER_ZONE("bucket bounds");
+		bounds_[0] = 0;
+		for(size_t bucket = 0; bucket < nb_; ++bucket)
+		{
+			size_t count = 0;
+			for(unsigned int t = 0; t < threads_; ++t)
+				count += counts_[t*nb_ + bucket];
+			bounds_[bucket+1] = bounds_[bucket] + count;
+		}
+
+		// full blocks of all stripes go to the array start:
+		// empty slots there get full blocks from the end
+		size_t fullblocks = 0;
+		for(unsigned int t = 0; t < threads_; ++t)
+			fullblocks += full_[t];
+
+		std::vector<size_t> empty, moved;
+		for(unsigned int t = 0; t < threads_; ++t)
+		{
+			size_t const first = t*stripe_ / B;
+			size_t const last = std::min(n_, (t+1)*stripe_) / B;
+			for(size_t slot = first; slot < last; ++slot)
+			{
+				bool const full = slot < first + full_[t];
+				if(!full && slot < fullblocks)
+					empty.push_back(slot);
+				else if(full && slot >= fullblocks)
+					moved.push_back(slot);
+			}
+		}
+		for(size_t i = 0; i < empty.size(); ++i)
+			std::copy(d_ + moved[i]*B, d_ + (moved[i]+1)*B, d_ + empty[i]*B);
+
+		// every bucket area: written blocks [start, write), unread
+		// blocks (read, areaend), read goes down from the last one
+		for(size_t bucket = 0; bucket < nb_; ++bucket)
+		{
+			ptrdiff_t const start = roundup_(bounds_[bucket]);
+			ptrdiff_t const end = std::min(roundup_(bounds_[bucket+1]), fullblocks*B);
+			write_[bucket] = start;
+			read_[bucket] = std::max(start, end) - ptrdiff_t(B);
+		}
+		return;
+	}
+
+
+
+	void permute_(unsigned int t)
+	{
+		CLEVER_ZONE("block permutation");
+		T *current = swap_.data() + t*2*B;
+		T *other = current + B;
+
+		size_t const first = t * nb_ / threads_;
+		for(size_t step = 0; step < nb_; ++step)
+		{
+			size_t const bucket = (first + step) % nb_;
+			for(;;)
+			{
+				{
+					std::lock_guard<std::mutex> lock(locks_[bucket]);
+					if(read_[bucket] < write_[bucket])
+						break;
+					T *const block = d_ + read_[bucket];
+					std::copy(block, block + B, current);
+					read_[bucket] -= B;
+				}
+
+				// block goes to its bucket, the block found there goes on
+				for(;;)
+				{
+					size_t const dest = cls_.classify(current[0]);
+					ptrdiff_t slot;
+					bool occupied;
+					{
+						std::lock_guard<std::mutex> lock(locks_[dest]);
+						slot = write_[dest];
+						write_[dest] += B;
+						occupied = slot <= read_[dest];
+					}
+
+					if(occupied)
+					{
+						std::copy(d_ + slot, d_ + slot + B, other);
+						std::copy(current, current + B, d_ + slot);
+						std::swap(current, other);
+						continue;
+					}
+
+					if(size_t(slot) + B > n_)
+					{
+						// the only block crossing the array end
+						std::copy(current, current + (n_ - slot), d_ + slot);
+						std::copy(current, current + B, overflow_.data());
+						overflowbucket_ = dest;
+						overflowslot_ = slot;
+					}
+					else
+					{
+						std::copy(current, current + B, d_ + slot);
+					}
+					break;
+				}
+			}
+		}
+		return;
+	}
+
+
+
+	void cleanup_()
+	{
+		CLEVER_ZONE("cleanup");
+		for(size_t bucket = 0; bucket < nb_; ++bucket)
+		{
+			size_t const lo = bounds_[bucket], hi = bounds_[bucket+1];
+			size_t const start = roundup_(lo);
+			size_t const written = write_[bucket];
+
+			// gaps: [lo, start) and [written, hi), filled in this order
+			size_t pos = lo;
+			size_t const headend = std::min(start, hi);
+			auto put = [&](T const &value) {
+				if(pos == headend)
+					pos = std::max(written, headend);
+				d_[pos++] = value;
+			};
+
+			// blocks crossing the next bucket start, before that bucket
+			// fills its own gaps
+			for(size_t i = std::max(hi, start); i < std::min(written, n_); ++i)
+				put(d_[i]);
+			if(overflowbucket_ == bucket)
+				for(size_t i = n_ - overflowslot_; i < B; ++i)
+					put(overflow_[i]);
+
+			for(unsigned int t = 0; t < threads_; ++t)
+			{
+				T const *const buffer = buffers_.data() + (t*nb_ + bucket)*B;
+				size_t const fill = fills_[t*nb_ + bucket];
+				for(size_t i = 0; i < fill; ++i)
+					put(buffer[i]);
+			}
+		}
+		return;
+	}
+
+
+
+	clever::TaskPool &pool_;
+	T *const d_;
+	size_t const n_;
+	unsigned int const threads_;
+	SampleClassifier<T> const &cls_;
+	size_t const nb_;
+	size_t stripe_ = 0;
+
+	std::vector<T> buffers_;
+	std::vector<size_t> fills_, counts_, full_;
+
+	std::vector<size_t> bounds_;
+	std::vector<ptrdiff_t> write_, read_;
+	std::unique_ptr<std::mutex[]> locks_;
+
+	std::vector<T> swap_, overflow_;
+	size_t overflowbucket_ = size_t(-1);
+	size_t overflowslot_ = 0;
+
+};
+
+
+
+// sorts [d, d+n) with up to threads threads for the first level,
+// base >= 2*SAMPLESORT_OVERSAMPLING keeps the sample smaller than n
+template<typename T>
+void sample_sort(
+	clever::TaskPool &pool, T *d, size_t n,
+	unsigned int threads, size_t cutoff, size_t base
+)
+{
+	if(n <= base)
+	{
+		pdq_sort(d, d + n);
+		return;
+	}
+
+	unsigned int logk = 1;
+	while(logk < SAMPLESORT_LOG_BUCKETS && (n >> logk) > base)
+		++logk;
+
+	// random sample to the array start, sorted
+	size_t const samplesize = SAMPLESORT_OVERSAMPLING << logk;
+	{
+		CLEVER_ZONE("sampling");
+		clever::Xoshiro256 rng(n);
+		for(size_t i = 0; i < samplesize; ++i)
+			std::swap(d[i], d[i + rng.bounded(n - i)]);
+		pdq_sort(d, d + samplesize);
+	}
+	SampleClassifier<T> const classifier(d, samplesize, logk);
+
+	threads = (unsigned int)std::max<size_t>(1u, std::min<size_t>(threads, n / cutoff));
+	std::vector<size_t> bounds;
+	{
+		SampleSortLevel<T> level(pool, d, n, threads, classifier);
+		bounds = level.partition();
+	}
+
+	// buckets between splitters, equal ones are done
+	clever::TaskGroup group;
+	for(size_t bucket = 0; bucket + 1 < bounds.size(); bucket += 2)
+	{
+		T *const b = d + bounds[bucket];
+		size_t const size = bounds[bucket+1] - bounds[bucket];
+		if(size <= base)
+			pdq_sort(b, b + size);
+		else
+			pool.spawn(group, [&pool, b, size, cutoff, base] {
+				sample_sort(pool, b, size, 1u, cutoff, base);
+			});
+	}
+	pool.wait(group);
+	return;
+}
+
+
+
+template<typename Array>
+void sample_sort(Array &ar)
+{
+	CLEVER_ZONE("sample_sort");
+	clever::TaskPool &pool = parallel_sort_pool();
+	size_t const cutoff = std::max<size_t>(1u, parallel_sort_settings().cutoff);
+	size_t const base = std::max<size_t>(
+		2*SAMPLESORT_OVERSAMPLING, parallel_sort_settings().samplebase
+	);
+	sample_sort(pool, ar.d, ar.n, pool.size(), cutoff, base);
+	return;
+}
+
+
+
+
+
+// end
+
+#endif
@@ -0,0 +1,336 @@
+#ifndef SELECT_CPP
+#define SELECT_CPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+#include <clever/Profiler.hpp>
+
+#include "../structures/random_array.cpp"
+#include "pdq_sort.cpp"
+
+
+
+
+
+/*
+ * Selection: k-th smallest element goes to position k, smaller or
+ * equal ones before it, greater or equal ones after it (nth_element).
+ *
+ *         quick_select             - quicksort recursing into one side
+ *         intro_select             - quick_select, after 2*log2(n)
+ *                                    partitions median of medians
+ *         floyd_rivest_select      - pivots from a recursively selected
+ *                                    sample, about n + min(k, n-k)
+ *                                    comparisons
+ *         median_of_medians_select - worst case linear (BFPRT)
+ *
+ * Array-level versions take k from selection_settings(), so the harness
+ * runs them like sorts (main --k=...).
+ */
+constexpr size_t const SELECT_INSERTION = 16u;
+constexpr size_t const FLOYD_RIVEST_SAMPLE = 600u;
+
+
+
+/*
+ * Rank of selection for the harness: "--k=V",
+ *
+ *         integer V         - V smallest elements (clamped to N)
+ *         V with point      - fraction of N, 0.5 is the median
+ */
+struct SelectionSettings
+{
+	double k = 0.5;
+	bool fraction = true;
+
+	bool parse(std::string const &s)
+	{
+		char *end;
+		double const v = std::strtod(s.c_str(), &end);
+		if(s.empty() || *end != 0 || !(v >= 0.0))
+			return false;
+		fraction = s.find('.') != std::string::npos;
+		if(fraction && v > 1.0)
+			return false;
+		k = v;
+		return true;
+	}
+
+	// number of elements before the selected one, 0..n
+	size_t rank(size_t n) const
+	{
+		double const r = fraction ? std::floor(k * n) : k;
+		return r < n ? size_t(r) : n;
+	}
+};
+
+inline SelectionSettings &selection_settings()
+{
+	static SelectionSettings settings;
+	return settings;
+}
+
+
+
+// partition around *b, returns final pivot position; equal elements
+// stop both scans, so duplicates are split evenly
+template<typename T>
+T *select_partition_at_first(T *b, T *e)
+{
+	T *i = b+1, *j = e-1;
+	while(true)
+	{
+		while(i <= j && *i < *b)
+			++i;
+		while(i <= j && *b < *j)
+			--j;
+		if(i >= j)
+			break;
+		std::swap(*i++, *j--);
+	}
+	std::swap(*b, *j);
+	return j;
+}
+
+// pivot is median of 3
+template<typename T>
+T *select_partition(T *b, T *e)
+{
+	T *const mid = b + (e - b)/2;
+	pdq_sort3(b, mid, e-1);
+	std::swap(*b, *mid);
+	return select_partition_at_first(b, e);
+}
+
+
+
+template<typename T>
+void quick_select(T *b, T *nth, T *e)
+{
+	while(size_t(e - b) > SELECT_INSERTION)
+	{
+		T *const p = select_partition(b, e);
+		if(p == nth)
+			return;
+		if(nth < p)
+			e = p;
+		else
+			b = p+1;
+	}
+	pdq_insertion_sort(b, e);
+	return;
+}
+
+template<typename T>
+void median_of_medians_select(T *b, T *nth, T *e)
+{
+	while(size_t(e - b) > SELECT_INSERTION)
+	{
+		// medians of groups of 5 to the start, pivot is their median
+		T *m = b;
+		for(T *g = b; e - g >= 5; g += 5)
+		{
+			pdq_insertion_sort(g, g+5);
+			std::swap(*m++, g[2]);
+		}
+		T *const pivot = b + (m - b)/2;
+		median_of_medians_select(b, pivot, m);
+		std::swap(*b, *pivot);
+
+		T *const j = select_partition_at_first(b, e);
+		if(j == nth)
+			return;
+		if(nth < j)
+			e = j;
+		else
+			b = j+1;
+	}
+	pdq_insertion_sort(b, e);
+	return;
+}
+
+template<typename T>
+void intro_select(T *b, T *nth, T *e)
+{
+	int budget = 0;
+	for(size_t n = e - b; n > 1; n >>= 1)
+		budget += 2;
+
+	while(size_t(e - b) > SELECT_INSERTION)
+	{
+		if(budget-- == 0)
+		{
+			median_of_medians_select(b, nth, e);
+			return;
+		}
+		T *const p = select_partition(b, e);
+		if(p == nth)
+			return;
+		if(nth < p)
+			e = p;
+		else
+			b = p+1;
+	}
+	pdq_insertion_sort(b, e);
+	return;
+}
+
+// Floyd, Rivest: SELECT (Algorithm 489), [left, right] inclusive
+template<typename T>
+void floyd_rivest_select(T *a, ptrdiff_t left, ptrdiff_t right, ptrdiff_t k)
+{
+	while(right > left)
+	{
+		if(size_t(right - left) > FLOYD_RIVEST_SAMPLE)
+		{
+			// sample of s elements around the expected place of k
+			double const n = right - left + 1;
+			double const i = k - left + 1;
+			double const z = std::log(n);
+			double const s = 0.5 * std::exp(2.0 * z / 3.0);
+			double const sd = 0.5 * std::sqrt(z * s * (n - s) / n) * (i < n/2 ? -1.0 : 1.0);
+			ptrdiff_t const newleft = std::max(left, ptrdiff_t(k - i*s/n + sd));
+			ptrdiff_t const newright = std::min(right, ptrdiff_t(k + (n - i)*s/n + sd));
+			floyd_rivest_select(a, newleft, newright, k);
+		}
+
+		T const t = a[k];
+		ptrdiff_t i = left, j = right;
+		std::swap(a[left], a[k]);
+		if(t < a[right])
+			std::swap(a[right], a[left]);
+		while(i < j)
+		{
+			std::swap(a[i], a[j]);
+			++i;
+			--j;
+			while(a[i] < t)
+				++i;
+			while(t < a[j])
+				--j;
+		}
+		if(!(a[left] < t) && !(t < a[left]))
+			std::swap(a[left], a[j]);
+		else
+		{
+			++j;
+			std::swap(a[j], a[right]);
+		}
+
+		if(j <= k)
+			left = j+1;
+		if(k <= j)
+			right = j-1;
+	}
+	return;
+}
+
+template<typename T>
+void floyd_rivest_select(T *b, T *nth, T *e)
+{
+	floyd_rivest_select(b, 0, e - b - 1, nth - b);
+	return;
+}
+
+
+
+// k-th smallest, k < n
+template<typename Array>
+void quick_select(Array &ar, size_t k)
+{
+	CLEVER_ZONE("quick_select");
+	quick_select(ar.d, ar.d + k, ar.d + ar.n);
+	return;
+}
+
+template<typename Array>
+void intro_select(Array &ar, size_t k)
+{
+	CLEVER_ZONE("intro_select");
+	intro_select(ar.d, ar.d + k, ar.d + ar.n);
+	return;
+}
+
+template<typename Array>
+void floyd_rivest_select(Array &ar, size_t k)
+{
+	CLEVER_ZONE("floyd_rivest_select");
+	floyd_rivest_select(ar.d, ar.d + k, ar.d + ar.n);
+	return;
+}
+
+template<typename Array>
+void median_of_medians_select(Array &ar, size_t k)
+{
+	CLEVER_ZONE("median_of_medians_select");
+	median_of_medians_select(ar.d, ar.d + k, ar.d + ar.n);
+	return;
+}
+
+template<typename Array>
+void std_nth_element(Array &ar, size_t k)
+{
+	CLEVER_ZONE("std_nth_element");
+	std::nth_element(ar.d, ar.d + k, ar.d + ar.n);
+	return;
+}
+
+
+
+// rank of the settings; all n elements select the last one
+template<typename Array, void(*Select)(Array &, size_t)>
+void select_by_settings(Array &ar)
+{
+	if(ar.n == 0)
+		return;
+	Select(ar, std::min<size_t>(selection_settings().rank(ar.n), ar.n - 1));
+	return;
+}
+
+template<typename Array>
+void quick_select(Array &ar)
+{
+	select_by_settings<Array, &quick_select<Array>>(ar);
+	return;
+}
+
+template<typename Array>
+void intro_select(Array &ar)
+{
+	select_by_settings<Array, &intro_select<Array>>(ar);
+	return;
+}
+
+template<typename Array>
+void floyd_rivest_select(Array &ar)
+{
+	select_by_settings<Array, &floyd_rivest_select<Array>>(ar);
+	return;
+}
+
+template<typename Array>
+void median_of_medians_select(Array &ar)
+{
+	select_by_settings<Array, &median_of_medians_select<Array>>(ar);
+	return;
+}
+
+template<typename Array>
+void std_nth_element(Array &ar)
+{
+	select_by_settings<Array, &std_nth_element<Array>>(ar);
+	return;
+}
+
+
+
+
+
+// end
+
+#endif
@@ -1,37 +1,59 @@
+#ifndef SELECTION_SORT_CPP
+#define SELECTION_SORT_CPP
+
 #include <utility>
+
+#include <clever/Profiler.hpp>
+
 #include "../structures/random_array.cpp"
+#include "compare.cpp"
 
 
 
 
 
 // find min element
-template<typename Iter>
-inline Iter find_min_element(Iter b, Iter e)
+template<typename Iter, typename Compare = Less>
+constexpr Iter find_min_element(Iter b, Iter e, Compare less = Compare())
 {
 	if(b == e)
 		return e;
 	Iter min = b;
 	while(++b != e) {
-		if(*b < *min)
+		if(less(*b, *min))
 			min = b;
 	}
 	return min;
 }
 
 
-void selection_sort(random_array_type &ar)
+// generic version, see compare.cpp
+template<typename Iter, typename Compare = Less, typename Projection = Identity>
+constexpr void selection_sort(Iter b, Iter e, Compare comp = Compare(), Projection proj = Projection())
 {
-	int *min;
-	for(auto *b = ar.d, *e = ar.d+ar.n; b < e; ++b) {
-		min = find_min_element(b, e);
-		std::swap(*min, *b);
+	auto const less = make_compare(comp, proj);
+
+	for(; b != e; ++b) {
+		Iter const min = find_min_element(b, e, less);
+		if(min != b)
+			sort_iter_swap(min, b);
 	}
 	return;
 }
 
 
+template<typename Array>
+void selection_sort(Array &ar)
+{
+	CLEVER_ZONE("selection_sort");
+	selection_sort(ar.d, ar.d+ar.n);
+	return;
+}
+
+
 
 
 
 // end
+
+#endif
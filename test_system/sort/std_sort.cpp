@@ -0,0 +1,38 @@
+#ifndef STD_SORT_CPP
+#define STD_SORT_CPP
+
+#include <algorithm>
+
+#include <clever/Profiler.hpp>
+
+#include "../structures/random_array.cpp"
+
+
+
+
+
+// standard library sorts, reference points for the others
+
+template<typename Array>
+void std_sort(Array &ar)
+{
+	CLEVER_ZONE("std_sort");
+	std::sort(ar.d, ar.d + ar.n);
+	return;
+}
+
+template<typename Array>
+void std_stable_sort(Array &ar)
+{
+	CLEVER_ZONE("std_stable_sort");
+	std::stable_sort(ar.d, ar.d + ar.n);
+	return;
+}
+
+
+
+
+
+// end
+
+#endif
@@ -0,0 +1,282 @@
+#ifndef STRING_SORT_CPP
+#define STRING_SORT_CPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <clever/Profiler.hpp>
+
+#include "../structures/string_array.cpp"
+
+
+
+
+
+/*
+ * String sorts: characters of a shared prefix are looked at once
+ * (or a few times), not in every comparison.
+ *
+ *         msd_radix_sort      - counting sort by the character at depth,
+ *                               characters cached in an oracle array,
+ *                               then every bucket one character deeper;
+ *                               a character shared by all strings is
+ *                               skipped without moves; stable
+ *         multikey_quick_sort - ternary partition by the character at
+ *                               depth (Bentley, Sedgewick); the equal
+ *                               part goes one character deeper
+ *         lcp_merge_sort      - merge sort keeping longest common prefixes
+ *                               of neighbours; a merge compares two
+ *                               strings only from their common prefix
+ *                               with the last output (Ng, Kakehi); stable
+ *
+ * Small ranges go to insertion sort comparing from the depth.
+ */
+constexpr size_t const STRING_INSERTION = 32u;
+
+
+
+// character at depth, 0 at the end
+inline unsigned char string_char(CString const &s, size_t depth)
+{
+	return s.s[depth];
+}
+
+// length of common prefix from h, and sign of comparison at it
+inline size_t string_compare_from(CString const &a, CString const &b, size_t h, int &cmp)
+{
+	while(a.s[h] != 0 && a.s[h] == b.s[h])
+		++h;
+	cmp = int(a.s[h]) - int(b.s[h]);
+	return h;
+}
+
+// strings share the first depth characters
+inline void string_insertion_sort(CString *d, size_t n, size_t depth)
+{
+	for(size_t i = 1; i < n; ++i)
+	{
+		CString const s = d[i];
+		size_t j = i;
+		for(int cmp; j > 0 && (string_compare_from(s, d[j-1], depth, cmp), cmp < 0); --j)
+			d[j] = d[j-1];
+		d[j] = s;
+	}
+	return;
+}
+
+
+
+inline void msd_radix_sort(
+	CString *d, size_t n, size_t depth, CString *buf, unsigned char *oracle
+)
+{
+	if(n < STRING_INSERTION)
+	{
+		string_insertion_sort(d, n, depth);
+		return;
+	}
+
+	size_t count[256];
+	while(true)
+	{
+		std::fill(count, count + 256, 0);
+		for(size_t i = 0; i < n; ++i)
+			++count[oracle[i] = string_char(d[i], depth)];
+
+		// the same character in all strings (shared prefix): no moves
+		if(count[oracle[0]] != n)
+			break;
+		if(oracle[0] == 0)
+			return;
+		++depth;
+	}
+
+	size_t start[256], sum = 0;
+	for(size_t c = 0; c < 256; ++c)
+	{
+		start[c] = sum;
+		sum += count[c];
+	}
+	for(size_t i = 0; i < n; ++i)
+		buf[start[oracle[i]]++] = d[i];
+	std::copy(buf, buf + n, d);
+
+	// bucket 0: strings ended, all equal
+	for(size_t c = 1, b = count[0]; c < 256; b += count[c++])
+		if(count[c] > 1)
+			msd_radix_sort(d + b, count[c], depth+1, buf, oracle);
+	return;
+}
+
+inline void multikey_quick_sort(CString *d, size_t n, size_t depth)
+{
+	while(n >= STRING_INSERTION)
+	{
+		unsigned char a = string_char(d[0], depth);
+		unsigned char b = string_char(d[n/2], depth);
+		unsigned char c = string_char(d[n-1], depth);
+		if(b < a)
+			std::swap(a, b);
+		if(c < b)
+			b = std::max(a, c);
+		unsigned char const pivot = b;
+
+		// [0, lt) less, [lt, i) equal, [gt, n) greater
+		size_t lt = 0, i = 0, gt = n;
+		while(i < gt)
+		{
+			unsigned char const ch = string_char(d[i], depth);
+			if(ch < pivot)
+				std::swap(d[lt++], d[i++]);
+			else if(pivot < ch)
+				std::swap(d[i], d[--gt]);
+			else
+				++i;
+		}
+
+		multikey_quick_sort(d, lt, depth);
+		if(pivot != 0)
+			multikey_quick_sort(d + lt, gt - lt, depth+1);
+		d += gt;
+		n -= gt;
+	}
+	string_insertion_sort(d, n, depth);
+	return;
+}
+
+
+
+// lcp[i] is common prefix of d[i-1] and d[i], lcp[0] is not used
+inline void lcp_merge(
+	CString const *a, size_t const *alcp, size_t na,
+	CString const *b, size_t const *blcp, size_t nb,
+	CString *out, size_t *outlcp
+)
+{
+	size_t i = 0, j = 0, k = 0;
+	// common prefixes of a[i] and b[j] with the last output
+	size_t ha = 0, hb = 0;
+
+	while(i < na && j < nb)
+	{
+		// the one sharing more with the last output is smaller;
+		// equal prefixes: compare from there
+		bool first = ha > hb;
+		if(ha == hb)
+		{
+			int cmp;
+			size_t const h = string_compare_from(a[i], b[j], ha, cmp);
+			first = cmp <= 0;
+			if(first)
+				hb = h;
+			else
+				ha = h;
+		}
+
+		if(first)
+		{
+			out[k] = a[i];
+			outlcp[k++] = ha;
+			if(++i < na)
+				ha = alcp[i];
+		}
+		else
+		{
+			out[k] = b[j];
+			outlcp[k++] = hb;
+			if(++j < nb)
+				hb = blcp[j];
+		}
+	}
+
+	for(; i < na; ha = ++i < na ? alcp[i] : 0)
+	{
+		out[k] = a[i];
+		outlcp[k++] = ha;
+	}
+	for(; j < nb; hb = ++j < nb ? blcp[j] : 0)
+	{
+		out[k] = b[j];
+		outlcp[k++] = hb;
+	}
+	return;
+}
+
+inline void lcp_merge_sort(
+	CString *d, size_t *lcp, size_t n, CString *buf, size_t *lcpbuf
+)
+{
+	if(n < STRING_INSERTION)
+	{
+		string_insertion_sort(d, n, 0);
+		for(size_t i = 1; i < n; ++i)
+		{
+			int cmp;
+			lcp[i] = string_compare_from(d[i-1], d[i], 0, cmp);
+		}
+		return;
+	}
+
+	size_t const half = n/2;
+	lcp_merge_sort(d, lcp, half, buf, lcpbuf);
+	lcp_merge_sort(d + half, lcp + half, n - half, buf, lcpbuf);
+	{
+		CLEVER_ZONE("merge");
+		lcp_merge(d, lcp, half, d + half, lcp + half, n - half, buf, lcpbuf);
+	}
+	std::copy(buf, buf + n, d);
+	std::copy(lcpbuf, lcpbuf + n, lcp);
+	return;
+}
+
+
+
+template<typename Array>
+void msd_radix_sort(Array &ar)
+{
+	CLEVER_ZONE("msd_radix_sort");
+	static thread_local std::vector<CString> buf;
+	static thread_local std::vector<unsigned char> oracle;
+	if(buf.size() < ar.n)
+	{
+		buf.resize(ar.n);
+		oracle.resize(ar.n);
+	}
+	msd_radix_sort(ar.d, ar.n, 0, buf.data(), oracle.data());
+	return;
+}
+
+template<typename Array>
+void multikey_quick_sort(Array &ar)
+{
+	CLEVER_ZONE("multikey_quick_sort");
+	multikey_quick_sort(ar.d, ar.n, 0);
+	return;
+}
+
+template<typename Array>
+void lcp_merge_sort(Array &ar)
+{
+	CLEVER_ZONE("lcp_merge_sort");
+	static thread_local std::vector<CString> buf;
+	static thread_local std::vector<size_t> lcp, lcpbuf;
+	if(buf.size() < ar.n)
+	{
+		buf.resize(ar.n);
+		lcp.resize(ar.n);
+		lcpbuf.resize(ar.n);
+	}
+	lcp_merge_sort(ar.d, lcp.data(), ar.n, buf.data(), lcpbuf.data());
+	return;
+}
+
+
+
+
+
+// end
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef TOP_K_CPP
+#define TOP_K_CPP
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include <clever/Profiler.hpp>
+
+#include "../structures/random_array.cpp"
+#include "pdq_sort.cpp"
+#include "select.cpp"
+
+
+
+
+
+/*
+ * Top-k: k smallest elements sorted at the start, the rest in any
+ * order (partial_sort). k comes from selection_settings() as in
+ * select.cpp, here it is the number of elements.
+ *
+ *         heap_top_k         - max-heap of the first k, every next
+ *                              element smaller than its top replaces it;
+ *                              O(n log k), one pass over the input
+ *         partial_quick_sort - quicksort not going right of k (Martinez):
+ *                              O(n + k log k)
+ *         std_partial_sort   - standard library
+ *         sort_top_k         - whole array by pdq_sort, the reference:
+ *                              full sort and slicing
+ */
+
+
+
+// top of the heap [b, e) is replaced, then sifted down
+template<typename T>
+void top_k_sift_down(T *b, T *e, T value)
+{
+	size_t const n = e - b;
+	size_t i = 0;
+	for(size_t child; (child = 2*i + 1) < n; i = child)
+	{
+		if(child + 1 < n && b[child] < b[child+1])
+			++child;
+		if(!(value < b[child]))
+			break;
+		b[i] = std::move(b[child]);
+	}
+	b[i] = std::move(value);
+	return;
+}
+
+template<typename T>
+void heap_top_k(T *b, T *m, T *e)
+{
+	if(b == m)
+		return;
+	{
+		CLEVER_ZONE("scan");
+		std::make_heap(b, m);
+		for(T *i = m; i != e; ++i)
+		{
+			if(!(*i < *b))
+				continue;
+			T value = std::move(*i);
+			*i = std::move(*b);
+			top_k_sift_down(b, m, std::move(value));
+		}
+	}
+	CLEVER_ZONE("sort heap");
+	std::sort_heap(b, m);
+	return;
+}
+
+template<typename T>
+void partial_quick_sort(T *b, T *m, T *e)
+{
+	while(size_t(e - b) > SELECT_INSERTION)
+	{
+		T *const p = select_partition(b, e);
+		if(p < m)
+		{
+			// everything left of the pivot is in the answer
+			pdq_sort(b, p);
+			b = p+1;
+		}
+		else
+			e = p;
+	}
+	pdq_insertion_sort(b, e);
+	return;
+}
+
+
+
+template<typename Array>
+void heap_top_k(Array &ar, size_t k)
+{
+	CLEVER_ZONE("heap_top_k");
+	heap_top_k(ar.d, ar.d + k, ar.d + ar.n);
+	return;
+}
+
+template<typename Array>
+void partial_quick_sort(Array &ar, size_t k)
+{
+	CLEVER_ZONE("partial_quick_sort");
+	partial_quick_sort(ar.d, ar.d + k, ar.d + ar.n);
+	return;
+}
+
+template<typename Array>
+void std_partial_sort(Array &ar, size_t k)
+{
+	CLEVER_ZONE("std_partial_sort");
+	std::partial_sort(ar.d, ar.d + k, ar.d + ar.n);
+	return;
+}
+
+template<typename Array>
+void sort_top_k(Array &ar, size_t)
+{
+	CLEVER_ZONE("sort_top_k");
+	pdq_sort(ar.d, ar.d + ar.n);
+	return;
+}
+
+
+
+template<typename Array>
+void heap_top_k(Array &ar)
+{
+	heap_top_k(ar, selection_settings().rank(ar.n));
+	return;
+}
+
+template<typename Array>
+void partial_quick_sort(Array &ar)
+{
+	partial_quick_sort(ar, selection_settings().rank(ar.n));
+	return;
+}
+
+template<typename Array>
+void std_partial_sort(Array &ar)
+{
+	std_partial_sort(ar, selection_settings().rank(ar.n));
+	return;
+}
+
+template<typename Array>
+void sort_top_k(Array &ar)
+{
+	sort_top_k(ar, selection_settings().rank(ar.n));
+	return;
+}
+
+
+
+
+
+// end
+
+#endif
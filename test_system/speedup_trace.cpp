@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <clever/Stopwatch.hpp>
+
+
+
+
+
+/*
+ * Speedup trace mode (parallel algorithms, see main.cpp).
+ *
+ * After every measured N the single-threaded baseline is timed
+ * on inputs of the same N with the same schedule (repeat runs,
+ * minimum and maximum excluded). Two charts are written next to
+ * the time chart:
+ *
+ *         "<output>.speedup.chart"        - baseline time / parallel time
+ *         "<output>.efficiency.chart"     - speedup / threads
+ */
+class SpeedupTrace
+{
+public:
+	void open(std::string const &outfilename, unsigned int threads)
+	{
+		threads_ = threads;
+		speedup_.reset(new std::ofstream(
+			outfilename + ".speedup.chart", std::ofstream::binary
+		));
+		efficiency_.reset(new std::ofstream(
+			outfilename + ".efficiency.chart", std::ofstream::binary
+		));
+		return;
+	}
+
+	bool good() const
+	{
+		return speedup_ && *speedup_ && efficiency_ && *efficiency_;
+	}
+
+
+	// time - microseconds of the parallel algorithm for this N
+	template<typename DataType, typename Algorithm>
+	void measure(
+		DataType &data, Algorithm baseline, size_t repeatcount, double time
+	)
+	{
+		using namespace std::chrono;
+		typedef duration<double, std::ratio<1, 1000000>> duration_type;
+
+		clever::Stopwatch<high_resolution_clock> watch;
+		std::vector<duration_type> durs(repeatcount);
+		for(auto &dur : durs) {
+			watch.reset();
+			data.update();
+			watch.start();
+			baseline(data);
+			watch.stop();
+			dur = duration_cast<duration_type>(watch.duration());
+		}
+
+		auto const maxdur = std::max_element(durs.begin(), durs.end());
+		auto const mindur = std::min_element(durs.begin(), durs.end());
+		duration_type base = duration_type::zero();
+		for(auto it = durs.begin(); it != durs.end(); ++it)
+			if(it != maxdur && it != mindur)
+				base += *it;
+
+		float const x = (float)data.getN();
+		float const speedup = time > 0 ? float(base.count() / time) : 0.f;
+		write_point_(*speedup_, x, speedup);
+		write_point_(*efficiency_, x, speedup / threads_);
+		return;
+	}
+
+private:
+	static void write_point_(std::ostream &os, float x, float y)
+	{
+		os.write( (char const *)&x, sizeof x );
+		os.write( (char const *)&y, sizeof y );
+		return;
+	}
+
+
+
+	unsigned int threads_ = 1;
+	std::unique_ptr<std::ofstream> speedup_, efficiency_;
+
+};
+
+
+SpeedupTrace speedup_trace;
+
+
+
+
+
+// end
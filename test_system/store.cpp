@@ -0,0 +1,332 @@
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "options.cpp"
+#include "result_store.cpp"
+
+
+
+
+
+using namespace std;
+
+
+
+char const *DEFAULT_STORE_DIR = "results";
+char const *COLORS[] = {
+	"black", "magenta", "green", "red", "blue", "cyan", "ff8000", "808080"
+};
+
+
+
+/*
+ * Result store tool (see result_store.cpp).
+ *
+ *         store [--store=dir] add <chart file> <algorithm> [distribution]
+ *                 [--variant=name] [--revision=rev] [--date=YYYY-MM-DD]
+ *
+ *         store [--store=dir] query [filter] [--latest]
+ *                 [--out=dir] [--config=file] [--font=file]
+ *
+ *         store [--store=dir] compare --reference=variant [filter] [--out=dir]
+ *
+ *         store host
+ *
+ * filter: [--algorithm=name] [--distribution=name] [--variant=name]
+ *         [--element=type] [--host=hex|this] [--revision=rev]
+ *         [--since=YYYY-MM-DD] [--until=YYYY-MM-DD]
+ *
+ * add without distribution takes it from the chart's info file
+ * (string runs by their shape, see ResultStore::add).
+ *
+ * query prints matching runs. With --out the run files are copied
+ * there as <algorithm>-<distribution>-<element>-<variant>-<id>.chart,
+ * and --config writes a chart_printer config drawing all of them.
+ * --latest keeps only the newest run of every series
+ * (algorithm, distribution, element, variant).
+ *
+ * compare takes the newest run of every series and prints the speedup
+ * of each build variant over the reference one, as geometric mean
+ * over the common N. With --out speedup by N is written to
+ * <series>-speedup.chart.
+ */
+
+
+
+
+
+int add(ResultStore &store, Options const &options)
+{
+	if(options.positionalCount() < 3) {
+		cerr << "usage: store add <chart file> <algorithm> [distribution]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	int64_t date = time(nullptr);
+	if(options.has("date") && !(date = parse_date(options.get("date")))) {
+		cerr << "invalid date '" << options.get("date") << "'" << endl;
+		return EXIT_FAILURE;
+	}
+
+	uint64_t id = store.add(
+		options.positional(1), options.positional(2),
+		options.positional(3), options.get("variant"),
+		options.get("revision", git_revision()), date
+	);
+	if(!id) {
+		cerr << "can't add '" << options.positional(1) <<
+			"' (unreadable, or a name too long for the index)" << endl;
+		return EXIT_FAILURE;
+	}
+
+	cout << id << endl;
+	return 0;
+}
+
+
+
+// filter from options, false on error
+bool read_filter(Options const &options, RunFilter &filter)
+{
+	filter.algorithm = options.get("algorithm");
+	filter.distribution = options.get("distribution");
+	filter.variant = options.get("variant");
+	filter.element = options.get("element");
+	filter.revision = options.get("revision");
+	if(options.has("host")) {
+		filter.host = options.get("host") == "this" ?
+			host_fingerprint() :
+			strtoull(options.get("host").c_str(), nullptr, 16);
+	}
+	if(options.has("since") && !(filter.since = parse_date(options.get("since")))) {
+		cerr << "invalid date '" << options.get("since") << "'" << endl;
+		return false;
+	}
+	if(options.has("until") && !(filter.until = parse_date(options.get("until")))) {
+		cerr << "invalid date '" << options.get("until") << "'" << endl;
+		return false;
+	}
+	return true;
+}
+
+std::string series_name(IndexRecord const &r)
+{
+	return std::string(r.algorithm) + "-" + r.distribution + "-" +
+		r.element + "-" + r.variant;
+}
+
+// newest run of every series
+void keep_latest(std::vector<IndexRecord> &runs)
+{
+	std::map<std::string, IndexRecord> latest;
+	for(auto const &r : runs) {
+		auto &l = latest[series_name(r)];
+		if(l.id == 0 || l.date <= r.date)
+			l = r;
+	}
+	runs.clear();
+	for(auto const &l : latest)
+		runs.push_back(l.second);
+	return;
+}
+
+
+
+int query(ResultStore const &store, Options const &options)
+{
+	RunFilter filter;
+	if(!read_filter(options, filter))
+		return EXIT_FAILURE;
+
+	std::vector<IndexRecord> runs = store.query(filter);
+	if(options.has("latest"))
+		keep_latest(runs);
+
+
+	// print
+	char date[32], host[32];
+	for(auto const &r : runs) {
+		time_t t = r.date;
+		strftime(date, sizeof date, "%Y-%m-%d %H:%M", gmtime(&t));
+		snprintf(host, sizeof host, "%016llx", (unsigned long long)r.host);
+		cout << r.id << '\t' << date << '\t' << host << '\t' <<
+			r.revision << '\t' << r.algorithm << '\t' <<
+			r.distribution << '\t' << r.element << '\t' << r.variant << endl;
+	}
+
+
+	// export
+	if(!options.has("out"))
+		return 0;
+
+	std::string const outdir = options.get("out", ".");
+	std::vector<std::string> files;
+	for(auto const &r : runs) {
+		std::string const name =
+			series_name(r) + "-" + std::to_string(r.id) + ".chart";
+		ifstream fin(store.runFileName(r.id), ifstream::binary);
+		ofstream fout(outdir + "/" + name, ofstream::binary);
+		if(!fin || !fout) {
+			cerr << "can't export run " << r.id << endl;
+			return EXIT_FAILURE;
+		}
+		fout << fin.rdbuf();
+		files.push_back(name);
+	}
+
+	if(options.has("config")) {
+		ofstream fout(options.get("config"));
+		if(!fout) {
+			cerr << "can't open file '" << options.get("config") << "'" << endl;
+			return EXIT_FAILURE;
+		}
+
+		fout << "# generated by store query\n\n";
+		fout << "padding = 200.0;\n";
+		fout << "backgroundcolor = \"fae7b5\";\n";
+		fout << "fontfilename = \"" << options.get("font", "opel.ttf") << "\";\n\n";
+		fout << "charts =\n(\n";
+		for(size_t i = 0; i < files.size(); ++i) {
+			fout << "\t{\n" <<
+				"\t\tthickness = 2.0;\n" <<
+				"\t\toverlayprior = " << i << ".0;\n" <<
+				"\t\tcolor = \"" << COLORS[i % (sizeof COLORS / sizeof *COLORS)] << "\";\n" <<
+				"\t\tdatafilename = \"" << outdir << "/" << files[i] << "\";\n" <<
+				"\t}" << (i+1 < files.size() ? "," : "") << "\n";
+		}
+		fout << ");\n";
+	}
+
+	return 0;
+}
+
+
+
+
+
+int compare(ResultStore const &store, Options const &options)
+{
+	RunFilter filter;
+	if(!read_filter(options, filter))
+		return EXIT_FAILURE;
+	std::string const reference = options.get("reference");
+	if(reference.empty()) {
+		cerr << "usage: store compare --reference=variant [filter]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	std::vector<IndexRecord> runs = store.query(filter);
+	keep_latest(runs);
+
+
+	// reference run of every algorithm/distribution
+	std::map<std::string, IndexRecord> refs;
+	for(auto const &r : runs)
+		if(reference == r.variant)
+			refs[std::string(r.algorithm) + "-" + r.distribution + "-" + r.element] = r;
+
+	printf(
+		"%-20s %-16s %-10s %-16s %8s\n",
+		"algorithm", "distribution", "element", "variant", "speedup"
+	);
+	for(auto const &r : runs) {
+		auto ref = refs.find(
+			std::string(r.algorithm) + "-" + r.distribution + "-" + r.element
+		);
+		if(ref == refs.end()) {
+			printf(
+				"%-20s %-16s %-10s %-16s %8s\n",
+				r.algorithm, r.distribution, r.element, r.variant, "no ref"
+			);
+			continue;
+		}
+
+		// speedup by N
+		std::map<float, float> reftimes;
+		for(auto const &p : store.readChart(ref->second.id))
+			reftimes[p.first] = p.second;
+
+		std::vector<std::pair<float, float>> speedup;
+		double logsum = 0.0;
+		for(auto const &p : store.readChart(r.id)) {
+			auto it = reftimes.find(p.first);
+			if(it == reftimes.end() || p.second <= 0.0f || it->second <= 0.0f)
+				continue;
+			speedup.emplace_back(p.first, it->second / p.second);
+			logsum += std::log(speedup.back().second);
+		}
+
+		if(speedup.empty()) {
+			printf(
+				"%-20s %-16s %-10s %-16s %8s\n",
+				r.algorithm, r.distribution, r.element, r.variant, "-"
+			);
+			continue;
+		}
+		printf(
+			"%-20s %-16s %-10s %-16s %8.3f\n",
+			r.algorithm, r.distribution, r.element, r.variant,
+			std::exp(logsum / speedup.size())
+		);
+
+		if(options.has("out")) {
+			std::string const name = options.get("out") + "/" +
+				series_name(r) + "-speedup.chart";
+			ofstream fout(name, ofstream::binary);
+			for(auto const &p : speedup) {
+				fout.write( (char const *)&p.first, sizeof p.first );
+				fout.write( (char const *)&p.second, sizeof p.second );
+			}
+			if(!fout) {
+				cerr << "can't write '" << name << "'" << endl;
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	return 0;
+}
+
+
+
+
+
+// main
+int main( int argc, char *argv[] )
+{
+	Options options(argc, argv);
+	std::string const command = options.positional(0);
+
+	if(command == "host") {
+		printf("%016llx\n", (unsigned long long)host_fingerprint());
+		return 0;
+	}
+
+	ResultStore store(options.get("store", DEFAULT_STORE_DIR));
+	if(command == "add") {
+		if(!store.open()) {
+			cerr << "can't open store" << endl;
+			return EXIT_FAILURE;
+		}
+		return add(store, options);
+	}
+	if(command == "query")
+		return query(store, options);
+	if(command == "compare")
+		return compare(store, options);
+
+	cerr << "usage: store add|query|compare|host, see store.cpp" << endl;
+	return EXIT_FAILURE;
+}
+
+
+
+
+
+// end
@@ -0,0 +1,249 @@
+#ifndef DISTRIBUTION_CPP
+#define DISTRIBUTION_CPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <clever/Random.hpp>
+
+#include "key_dump.cpp"
+
+
+
+
+/*
+ * Shape of input array, "name" or "name:parameter":
+ *
+ *         random             - random permutation of 0..n-1
+ *         sorted             - 0..n-1
+ *         reversed           - n-1..0
+ *         nearly_sorted:k    - sorted, then k random swaps (8)
+ *         runs:r             - r ascending runs of random values (8)
+ *         sawtooth:t         - t ascending teeth (8)
+ *         organ_pipe         - 0..n/2 ascending, then descending
+ *         duplicates:u       - random values from u distinct keys (16)
+ *         zipf:s             - keys 0..n-1 with Zipf law, exponent s (1.0)
+ *         replay:file        - first n keys of a key dump, see key_dump.cpp
+ *         sample:file        - n random keys of a key dump, in file order
+ */
+class Distribution
+{
+public:
+	enum Kind
+	{
+		RANDOM, SORTED, REVERSED, NEARLY_SORTED, RUNS,
+		SAWTOOTH, ORGAN_PIPE, DUPLICATES, ZIPF, REPLAY, SAMPLE
+	};
+
+
+
+	Distribution(): kind_(RANDOM), param_(0.0) {}
+
+	// false if name unknown, parameter invalid or dump can't be opened
+	bool parse(std::string const &s)
+	{
+		size_t const colon = s.find(':');
+		std::string const name = s.substr(0, colon);
+		if(name == "replay" || name == "sample") {
+			kind_ = name == "replay" ? REPLAY : SAMPLE;
+			name_ = name;
+			param_ = 0.0;
+			file_ = colon == std::string::npos ? "" : s.substr(colon + 1);
+			dump_ = std::make_shared<KeyDump>();
+			return dump_->open(file_);
+		}
+
+		static char const *const NAMES[] = {
+			"random", "sorted", "reversed", "nearly_sorted", "runs",
+			"sawtooth", "organ_pipe", "duplicates", "zipf"
+		};
+		static double const DEFAULTS[] = {
+			0.0, 0.0, 0.0, 8.0, 8.0, 8.0, 0.0, 16.0, 1.0
+		};
+
+		for(int i = 0; i <= ZIPF; ++i) {
+			if(name != NAMES[i])
+				continue;
+
+			kind_ = Kind(i);
+			name_ = name;
+			param_ = DEFAULTS[i];
+			if(colon != std::string::npos) {
+				char *end;
+				param_ = std::strtod(s.c_str() + colon + 1, &end);
+				if(*end != 0 || DEFAULTS[i] == 0.0)
+					return false;
+			}
+			return param_ >= 0.0 && (kind_ != ZIPF || param_ > 0.0);
+		}
+		return false;
+	}
+
+
+
+	Kind getKind() const
+	{
+		return kind_;
+	}
+	double getParam() const
+	{
+		return param_;
+	}
+	bool hasParam() const
+	{
+		return
+			kind_ == NEARLY_SORTED || kind_ == RUNS || kind_ == SAWTOOTH ||
+			kind_ == DUPLICATES || kind_ == ZIPF;
+	}
+	std::string getName() const
+	{
+		return name_.empty() ? "random" : name_;
+	}
+
+	// key dump of replay and sample
+	bool hasFile() const
+	{
+		return kind_ == REPLAY || kind_ == SAMPLE;
+	}
+	std::string getFile() const
+	{
+		return file_;
+	}
+
+	// the biggest array fill() can make
+	uint64_t maxSize() const
+	{
+		return hasFile() ? dump_->getCount() : UINT64_MAX;
+	}
+
+
+
+	// fill array of n elements
+	template<typename T, typename Rng>
+	void fill(T *d, size_t n, Rng &rng)
+	{
+		switch(kind_) {
+		case RANDOM:
+			// one value of rng per array, so big arrays are
+			// shuffled in parallel with the same result
+			for(size_t i = 0; i < n; ++i)
+				d[i] = T(i);
+			clever::parallel_shuffle(d, n, rng());
+			break;
+
+		case SORTED:
+			for(size_t i = 0; i < n; ++i)
+				d[i] = T(i);
+			break;
+
+		case REVERSED:
+			for(size_t i = 0; i < n; ++i)
+				d[i] = T(n-1-i);
+			break;
+
+		case NEARLY_SORTED:
+			for(size_t i = 0; i < n; ++i)
+				d[i] = T(i);
+			for(size_t k = 0; n > 1 && k < size_t(param_); ++k)
+				std::swap(d[rng() % n], d[rng() % n]);
+			break;
+
+		case RUNS:
+		{
+			size_t const runs = std::max<size_t>(1, param_);
+			uniform_(d, n, std::max<size_t>(n, 1), rng());
+			for(size_t r = 0; r < runs; ++r)
+				std::sort(d + n*r/runs, d + n*(r+1)/runs);
+			break;
+		}
+
+		case SAWTOOTH:
+		{
+			size_t const tooth = std::max<size_t>(1, n / std::max(1.0, param_));
+			for(size_t i = 0; i < n; ++i)
+				d[i] = T(i % tooth);
+			break;
+		}
+
+		case ORGAN_PIPE:
+			for(size_t i = 0; i < n; ++i)
+				d[i] = T(i < n/2 ? i : n-1-i);
+			break;
+
+		case DUPLICATES:
+		{
+			uniform_(d, n, std::max<size_t>(1, param_), rng());
+			break;
+		}
+
+		case ZIPF:
+		{
+			// cumulative weights 1/k^s, rebuilt when n changes
+			if(zipfcdf_.size() != n) {
+				zipfcdf_.resize(n);
+				double sum = 0.0;
+				for(size_t k = 0; k < n; ++k)
+					zipfcdf_[k] = sum += 1.0 / std::pow(double(k+1), param_);
+			}
+			std::uniform_real_distribution<double> u(
+				0.0, n ? zipfcdf_.back() : 0.0
+			);
+			for(size_t i = 0; i < n; ++i) {
+				d[i] = T(std::min<size_t>(n-1, std::lower_bound(
+					zipfcdf_.begin(), zipfcdf_.end(), u(rng)
+				) - zipfcdf_.begin()));
+			}
+			break;
+		}
+
+		case REPLAY:
+			dump_->prefix(d, n);
+			break;
+
+		case SAMPLE:
+			dump_->sample(d, n, rng());
+			break;
+		}
+
+		return;
+	}
+
+private:
+	// n values uniform in [0, range) by blocks of vectorized generator
+	template<typename T>
+	static void uniform_(T *d, size_t n, size_t range, uint64_t seed)
+	{
+		constexpr size_t const BLOCK = 1024;
+		clever::Xoshiro256x4 rng(seed);
+		uint64_t block[BLOCK];
+		for(size_t i = 0; i < n; i += BLOCK) {
+			size_t const count = std::min(BLOCK, n - i);
+			rng.fill(block, count);
+			for(size_t j = 0; j < count; ++j)
+				d[i+j] = T((__uint128_t)block[j] * range >> 64);
+		}
+		return;
+	}
+
+
+
+	Kind kind_;
+	std::string name_;
+	double param_;
+	std::vector<double> zipfcdf_;
+	std::string file_;
+	std::shared_ptr<KeyDump> dump_;
+
+};
+
+
+
+
+
+#endif
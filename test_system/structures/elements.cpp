@@ -0,0 +1,114 @@
+#ifndef ELEMENTS_CPP
+#define ELEMENTS_CPP
+
+#include <cstdint>
+#include <cstring>
+
+
+
+
+
+/*
+ * Element types for benchmarks besides plain numbers.
+ * All of them are ordered by key only and constructible from integer,
+ * so Distribution can fill them.
+ *
+ *         Record<Size> - key and inline payload of Size bytes,
+ *                        sizeof == 8 + Size (record16 moves 24 bytes)
+ *         KeyPointer   - key and pointer to payload stored elsewhere
+ */
+template<size_t Size>
+struct Record
+{
+	static_assert(Size > 0, "record without payload is int64_t");
+
+	int64_t key;
+	char payload[Size];
+
+	Record() = default;
+	explicit Record(int64_t k): key(k)
+	{
+		std::memset(payload, int(k), sizeof payload);
+		return;
+	}
+};
+
+template<size_t Size>
+inline bool operator<(Record<Size> const &lhs, Record<Size> const &rhs)
+{
+	return lhs.key < rhs.key;
+}
+
+
+
+struct KeyPointer
+{
+	int64_t key;
+	char const *payload;
+
+	KeyPointer() = default;
+	explicit KeyPointer(int64_t k): key(k), payload(pool_() + (k & 1023)*64) {}
+
+private:
+	static char const *pool_()
+	{
+		static char pool[1024*64];
+		return pool;
+	}
+};
+
+inline bool operator<(KeyPointer const &lhs, KeyPointer const &rhs)
+{
+	return lhs.key < rhs.key;
+}
+
+
+
+typedef Record<16> record16;
+typedef Record<32> record32;
+typedef Record<64> record64;
+typedef Record<128> record128;
+typedef Record<256> record256;
+typedef Record<512> record512;
+typedef Record<1024> record1024;
+
+
+
+
+
+// name of element type for run description
+template<typename T>
+struct ElementTraits
+{
+	static char const *name()
+	{
+		return "unknown";
+	}
+};
+
+#define ELEMENT_TRAITS(type, str) \
+	template<> struct ElementTraits<type> \
+	{ \
+		static char const *name() { return str; } \
+	}
+
+ELEMENT_TRAITS(int, "int32");
+ELEMENT_TRAITS(int64_t, "int64");
+ELEMENT_TRAITS(float, "float");
+ELEMENT_TRAITS(double, "double");
+ELEMENT_TRAITS(record16, "record16");
+ELEMENT_TRAITS(record32, "record32");
+ELEMENT_TRAITS(record64, "record64");
+ELEMENT_TRAITS(record128, "record128");
+ELEMENT_TRAITS(record256, "record256");
+ELEMENT_TRAITS(record512, "record512");
+ELEMENT_TRAITS(record1024, "record1024");
+ELEMENT_TRAITS(KeyPointer, "keyptr");
+
+#undef ELEMENT_TRAITS
+
+
+
+
+
+#endif
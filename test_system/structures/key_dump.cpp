@@ -0,0 +1,232 @@
+#ifndef KEY_DUMP_CPP
+#define KEY_DUMP_CPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <clever/Random.hpp>
+
+static_assert(
+	__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+	"key dumps are read without byte swapping"
+);
+
+
+
+
+
+/*
+ * Binary dump of recorded keys:
+ *
+ *         KeyDumpHeader           - 24 bytes, see below
+ *         key[count]              - signed little-endian integers
+ *                                   of keysize bytes (4 or 8)
+ *
+ * The file is memory-mapped, so only the pages of requested keys
+ * are read. Files larger than RAM are read by windows: pages ahead
+ * are prefetched, pages behind are dropped from the mapping.
+ */
+struct KeyDumpHeader
+{
+	char magic[8];          // "CLVKEYS\0"
+	uint32_t version;       // 1
+	uint32_t keysize;       // 4 or 8
+	uint64_t count;
+};
+
+static_assert(sizeof(KeyDumpHeader) == 24, "header is written as is");
+
+
+
+class KeyDump
+{
+public:
+	KeyDump() = default;
+	~KeyDump()
+	{
+		close();
+		return;
+	}
+
+	KeyDump(KeyDump const &) = delete;
+	KeyDump &operator=(KeyDump const &) = delete;
+
+
+
+	// false if file can't be mapped or isn't a key dump
+	bool open(std::string const &filename)
+	{
+		close();
+
+		int fd = ::open(filename.c_str(), O_RDONLY);
+		if(fd < 0)
+			return false;
+
+		struct stat st;
+		if(fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(KeyDumpHeader)) {
+			::close(fd);
+			return false;
+		}
+
+		void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if(p == MAP_FAILED)
+			return false;
+		base_ = (char const *)p;
+		size_ = st.st_size;
+
+		KeyDumpHeader h;
+		std::memcpy(&h, base_, sizeof h);
+		if(
+			std::memcmp(h.magic, MAGIC, sizeof h.magic) != 0 || h.version != 1 ||
+			(h.keysize != 4 && h.keysize != 8) ||
+			h.count > (size_ - sizeof h) / h.keysize
+		) {
+			close();
+			return false;
+		}
+
+		keysize_ = h.keysize;
+		count_ = h.count;
+		return true;
+	}
+
+	void close()
+	{
+		if(base_)
+			munmap((void *)base_, size_);
+		base_ = nullptr;
+		size_ = count_ = 0;
+		return;
+	}
+
+
+
+	bool good() const
+	{
+		return base_ != nullptr;
+	}
+	uint64_t getCount() const
+	{
+		return count_;
+	}
+	unsigned int getKeySize() const
+	{
+		return keysize_;
+	}
+
+	int64_t key(uint64_t i) const
+	{
+		char const *p = base_ + sizeof(KeyDumpHeader) + i * keysize_;
+		if(keysize_ == 4) {
+			int32_t k;
+			std::memcpy(&k, p, sizeof k);
+			return k;
+		}
+		int64_t k;
+		std::memcpy(&k, p, sizeof k);
+		return k;
+	}
+
+
+
+	// first n keys of the file, n <= getCount()
+	template<typename T>
+	void prefix(T *d, size_t n) const
+	{
+		for(size_t b = 0; b < n; b += WINDOW) {
+			size_t const e = std::min<size_t>(n, b + WINDOW);
+			advise_(e, std::min<size_t>(n, e + WINDOW), MADV_WILLNEED);
+			for(size_t i = b; i < e; ++i)
+				d[i] = T(key(i));
+			if(size_ > WINDOW * keysize_ * 4)
+				advise_(b, e, MADV_DONTNEED);
+		}
+		return;
+	}
+
+	/*
+	 * n distinct keys at random positions, in file order, so sorted
+	 * and clustered parts of the file keep their shape.
+	 * Positions are chosen by Floyd's algorithm, O(n) for any file size.
+	 */
+	template<typename T>
+	void sample(T *d, size_t n, uint64_t seed) const
+	{
+		clever::Xoshiro256 rng(seed);
+		std::unordered_set<uint64_t> chosen;
+		chosen.reserve(n);
+		for(uint64_t j = count_ - n; j < count_; ++j) {
+			uint64_t const t = rng.bounded(j + 1);
+			chosen.insert(chosen.count(t) ? j : t);
+		}
+
+		std::vector<uint64_t> positions(chosen.begin(), chosen.end());
+		std::sort(positions.begin(), positions.end());
+		for(size_t i = 0; i < n; ++i)
+			d[i] = T(key(positions[i]));
+		return;
+	}
+
+
+
+	// writes dump of keys, false on failure
+	template<typename Key>
+	static bool write(std::string const &filename, Key const *keys, uint64_t count)
+	{
+		static_assert(sizeof(Key) == 4 || sizeof(Key) == 8, "keys are 4 or 8 bytes");
+
+		KeyDumpHeader h;
+		std::memcpy(h.magic, MAGIC, sizeof h.magic);
+		h.version = 1;
+		h.keysize = sizeof(Key);
+		h.count = count;
+
+		std::ofstream fout(filename, std::ofstream::binary | std::ofstream::trunc);
+		fout.write((char const *)&h, sizeof h);
+		fout.write((char const *)keys, count * sizeof(Key));
+		return bool(fout);
+	}
+
+private:
+	// keys per window of streamed reading, 64 MiB of 8-byte keys
+	constexpr static size_t const WINDOW = size_t(1) << 23;
+	constexpr static char const MAGIC[8] = { 'C', 'L', 'V', 'K', 'E', 'Y', 'S', 0 };
+
+	// madvise for keys [b, e), rounded to whole pages inside them
+	void advise_(size_t b, size_t e, int advice) const
+	{
+		static size_t const PAGE = sysconf(_SC_PAGESIZE);
+		size_t from = sizeof(KeyDumpHeader) + b * keysize_;
+		size_t to = sizeof(KeyDumpHeader) + e * keysize_;
+		from = (from + PAGE - 1) / PAGE * PAGE;
+		to = to / PAGE * PAGE;
+		if(from < to)
+			madvise((void *)(base_ + from), to - from, advice);
+		return;
+	}
+
+
+
+	char const *base_ = nullptr;
+	size_t size_ = 0;
+	uint64_t count_ = 0;
+	unsigned int keysize_ = 0;
+
+};
+
+
+
+
+
+#endif
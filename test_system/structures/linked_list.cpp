@@ -0,0 +1,259 @@
+#ifndef LINKED_LIST_CPP
+#define LINKED_LIST_CPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <unistd.h>
+
+#include <clever/Random.hpp>
+
+#include "Data.hpp"
+#include "distribution.cpp"
+#include "elements.cpp"
+
+
+
+
+
+/*
+ * Where the nodes of a list live, "name":
+ *
+ *         sequential         - one array, list goes in address order
+ *         shuffled           - one array, list goes in random order
+ *         scattered          - every node on its own page, at a random
+ *                              offset, pages in random order
+ */
+class ListLayout
+{
+public:
+	enum Kind
+	{
+		SEQUENTIAL, SHUFFLED, SCATTERED
+	};
+
+
+
+	ListLayout(): kind_(SEQUENTIAL) {}
+
+	// false if name unknown
+	bool parse(std::string const &s)
+	{
+		static char const *const NAMES[] = {
+			"sequential", "shuffled", "scattered"
+		};
+
+		for(int i = 0; i <= SCATTERED; ++i) {
+			if(s == NAMES[i]) {
+				kind_ = Kind(i);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	Kind getKind() const
+	{
+		return kind_;
+	}
+	std::string getName() const
+	{
+		static char const *const NAMES[] = {
+			"sequential", "shuffled", "scattered"
+		};
+		return NAMES[kind_];
+	}
+
+private:
+	Kind kind_;
+
+};
+
+
+
+// node of singly linked list
+template<typename T>
+struct ListNode
+{
+	T value;
+	ListNode *next;
+};
+
+
+
+
+
+// struct
+template<typename T>
+struct ListStruct
+{
+	typedef T value_type;
+	typedef ListNode<T> node_type;
+
+	node_type *head;
+	unsigned int n;
+
+	uint64_t seed;
+	clever::Xoshiro256 rng;
+	Distribution distribution;
+	ListLayout layout;
+};
+
+
+
+
+
+/*
+ * Data for singly linked lists. Nodes are allocated once per N
+ * in the pool of the layout; update() writes new values and
+ * links the nodes in the order of the layout again, so every run
+ * starts from the same memory picture.
+ */
+template<typename T>
+class Data<ListStruct<T>>: public ListStruct<T>
+{
+public:
+	typedef ListStruct<T> data_type;
+	typedef ListNode<T> node_type;
+
+	static_assert(
+		std::is_trivially_destructible<T>::value,
+		"nodes are never destroyed"
+	);
+
+	Data();
+	~Data() = default;
+
+	Data(Data const &) = delete;
+	Data &operator=(Data const &) = delete;
+
+	Data &update();
+	unsigned int getN() const;
+	Data &next();
+
+	Data &reseed(uint64_t seed);
+
+private:
+	void allocate_();
+
+
+
+	std::unique_ptr<char[]> pool_;
+	std::vector<node_type *> order_;
+	std::vector<T> values_;
+
+};
+
+
+
+// Data constructor
+template<typename T>
+Data<ListStruct<T>>::Data():
+	ListStruct<T>{
+		nullptr, 1, 0, clever::Xoshiro256(), Distribution(), ListLayout()
+	}
+{
+	reseed(std::chrono::system_clock::now().time_since_epoch().count());
+	return;
+}
+
+
+
+// Data interface method
+template<typename T>
+Data<ListStruct<T>> &Data<ListStruct<T>>::update()
+{
+	// nodes are allocated on the first update of every N
+	if(order_.size() != this->n)
+		allocate_();
+
+	this->distribution.fill(values_.data(), this->n, this->rng);
+
+	for(unsigned int i = 0; i < this->n; ++i) {
+		order_[i]->value = values_[i];
+		order_[i]->next = i+1 < this->n ? order_[i+1] : nullptr;
+	}
+	this->head = this->n ? order_[0] : nullptr;
+
+	return *this;
+}
+
+template<typename T>
+unsigned int Data<ListStruct<T>>::getN() const
+{
+	return this->n;
+}
+
+template<typename T>
+Data<ListStruct<T>> &Data<ListStruct<T>>::next()
+{
+	++this->n;
+	update();
+	return *this;
+}
+
+// same seed gives the same sequence of lists
+template<typename T>
+Data<ListStruct<T>> &Data<ListStruct<T>>::reseed(uint64_t seed)
+{
+	this->seed = seed;
+	this->rng.seed(seed);
+	return *this;
+}
+
+
+
+// pool and order of nodes for the current N and layout
+template<typename T>
+void Data<ListStruct<T>>::allocate_()
+{
+	static size_t const PAGE = sysconf(_SC_PAGESIZE);
+	size_t const n = this->n;
+
+	size_t const stride =
+		this->layout.getKind() == ListLayout::SCATTERED ?
+		std::max(PAGE, sizeof(node_type)) : sizeof(node_type);
+	pool_.reset(new char[n * stride + alignof(node_type)]);
+	char *base = pool_.get();
+	base += (alignof(node_type) - uintptr_t(base) % alignof(node_type)) %
+		alignof(node_type);
+
+	// slot of i-th node; a random offset inside the page,
+	// so that scattered nodes don't fall into one cache set
+	order_.resize(n);
+	for(size_t i = 0; i < n; ++i) {
+		size_t offset = 0;
+		if(stride > sizeof(node_type)) {
+			size_t const slots = (stride - sizeof(node_type)) / alignof(node_type);
+			offset = this->rng.bounded(slots + 1) * alignof(node_type);
+		}
+		order_[i] = new(base + i*stride + offset) node_type;
+	}
+
+	if(this->layout.getKind() != ListLayout::SEQUENTIAL)
+		clever::shuffle(order_.begin(), order_.end(), this->rng);
+
+	values_.resize(n);
+	return;
+}
+
+
+
+
+
+template<typename T>
+using list_type = Data<ListStruct<T>>;
+
+
+
+
+
+// end
+
+#endif
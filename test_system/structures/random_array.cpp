@@ -1,89 +1,128 @@
+#ifndef RANDOM_ARRAY_CPP
+#define RANDOM_ARRAY_CPP
+
 #include <algorithm>
 #include <chrono>
-#include <random>
+#include <cstdint>
+
+#include <clever/Random.hpp>
 
 #include "Data.hpp"
+#include "distribution.cpp"
+#include "elements.cpp"
 
 
 
 
 
 // struct
-struct RandomArrayStruct
+template<typename T>
+struct ArrayStruct
 {
-	int *d;
+	typedef T value_type;
+
+	T *d;
 	unsigned int n;
 
-	std::default_random_engine dre;
+	uint64_t seed;          // regenerates the whole run, see reseed()
+	clever::Xoshiro256 rng;
+	Distribution distribution;
 };
 
+typedef ArrayStruct<int> RandomArrayStruct;
 
 
 
 
+
+// Data for arrays of any element type
+template<typename T>
+class Data<ArrayStruct<T>>: public ArrayStruct<T>
+{
+public:
+	typedef ArrayStruct<T> data_type;
+
+	Data();
+	~Data();
+
+	Data(Data const &) = delete;
+	Data &operator=(Data const &) = delete;
+
+	Data &update();
+	unsigned int getN() const;
+	Data &next();
+
+	Data &reseed(uint64_t seed);
+
+};
+
+
+
 // Data constructor, destructor
-template<>
-Data<RandomArrayStruct>::Data():
-	RandomArrayStruct{
-		new int[1], 1,
-		std::default_random_engine(
-			std::chrono::system_clock::now().
-			time_since_epoch().count()
-		)
-	}
+template<typename T>
+Data<ArrayStruct<T>>::Data():
+	ArrayStruct<T>{ new T[1], 1, 0, clever::Xoshiro256(), Distribution() }
 {
-	*d = 0;
+	*this->d = T(0);
+	reseed(std::chrono::system_clock::now().time_since_epoch().count());
 	return;
 }
 
-template<>
-Data<RandomArrayStruct>::~Data()
+template<typename T>
+Data<ArrayStruct<T>>::~Data()
 {
-	if(d)
-		delete[] d;
+	if(this->d)
+		delete[] this->d;
 	return;
 }
 
 
 
 // Data interface method
-template<>
-Data<RandomArrayStruct> &Data<RandomArrayStruct>::update()
+template<typename T>
+Data<ArrayStruct<T>> &Data<ArrayStruct<T>>::update()
 {
-	std::shuffle(d, d+n, dre);
+	this->distribution.fill(this->d, this->n, this->rng);
 	return *this;
 }
 
-template<>
-unsigned int Data<RandomArrayStruct>::getN() const
+template<typename T>
+unsigned int Data<ArrayStruct<T>>::getN() const
 {
-	return n;
+	return this->n;
 }
 
-template<>
-Data<RandomArrayStruct> &Data<RandomArrayStruct>::next()
+template<typename T>
+Data<ArrayStruct<T>> &Data<ArrayStruct<T>>::next()
 {
 	// resize
-	if(d)
-		delete[] d;
-	++n;
-	d = new int[n];
+	if(this->d)
+		delete[] this->d;
+	++this->n;
+	this->d = new T[this->n];
 
 	// fill
-	for(size_t i = 0; i < n; ++i) {
-		d[i] = i;
-	}
-
-	// randomize
 	update();
 
 	return *this;
 }
 
+// same seed gives the same sequence of arrays
+template<typename T>
+Data<ArrayStruct<T>> &Data<ArrayStruct<T>>::reseed(uint64_t seed)
+{
+	this->seed = seed;
+	this->rng.seed(seed);
+	return *this;
+}
+
 
 
 
 
+template<typename T>
+using array_type = Data<ArrayStruct<T>>;
+
 typedef Data<RandomArrayStruct> random_array_type;
 
 
@@ -91,3 +130,5 @@ typedef Data<RandomArrayStruct> random_array_type;
 
 
 // end
+
+#endif
@@ -0,0 +1,294 @@
+#ifndef STRING_ARRAY_CPP
+#define STRING_ARRAY_CPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <clever/Random.hpp>
+
+#include "Data.hpp"
+#include "distribution.cpp"
+#include "elements.cpp"
+
+
+
+
+
+// null-terminated string, compared as strcmp does (unsigned chars)
+struct CString
+{
+	unsigned char const *s;
+};
+
+inline bool operator<(CString const &lhs, CString const &rhs)
+{
+	return std::strcmp((char const *)lhs.s, (char const *)rhs.s) < 0;
+}
+
+template<>
+struct ElementTraits<CString>
+{
+	static char const *name()
+	{
+		return "string";
+	}
+};
+
+
+
+/*
+ * Set of strings of an input, "name" or "name:parameter":
+ *
+ *         random:l           - random letters, length 1..l (16)
+ *         prefix:p           - one shared prefix of p letters, then
+ *                              random tail of 1..16 letters (32), as URLs
+ *         dictionary:w       - words of w random roots (1024) with
+ *                              common suffixes, some of them compound,
+ *                              as identifiers
+ */
+class StringShape
+{
+public:
+	enum Kind
+	{
+		RANDOM, PREFIX, DICTIONARY
+	};
+
+
+
+	StringShape(): kind_(RANDOM), param_(16) {}
+
+	// false if name unknown or parameter invalid
+	bool parse(std::string const &s)
+	{
+		static char const *const NAMES[] = {
+			"random", "prefix", "dictionary"
+		};
+		static unsigned long const DEFAULTS[] = {
+			16, 32, 1024
+		};
+
+		size_t const colon = s.find(':');
+		std::string const name = s.substr(0, colon);
+		for(int i = 0; i <= DICTIONARY; ++i) {
+			if(name != NAMES[i])
+				continue;
+
+			kind_ = Kind(i);
+			param_ = DEFAULTS[i];
+			if(colon != std::string::npos) {
+				char *end;
+				param_ = std::strtoul(s.c_str() + colon + 1, &end, 10);
+				if(*end != 0 || s.size() == colon + 1)
+					return false;
+			}
+			return kind_ == PREFIX || param_ > 0;
+		}
+		return false;
+	}
+
+	Kind getKind() const
+	{
+		return kind_;
+	}
+	unsigned long getParam() const
+	{
+		return param_;
+	}
+	std::string getName() const
+	{
+		static char const *const NAMES[] = {
+			"random", "prefix", "dictionary"
+		};
+		return NAMES[kind_];
+	}
+
+
+
+	// n strings of the shape, sorted
+	template<typename Rng>
+	std::vector<std::string> generate(size_t n, Rng &rng) const
+	{
+		auto letters = [&rng](std::string &s, size_t count) {
+			for(size_t i = 0; i < count; ++i)
+				s.push_back(char('a' + rng.bounded(26)));
+		};
+
+		std::vector<std::string> set(n);
+		switch(kind_) {
+		case RANDOM:
+			for(auto &s : set)
+				letters(s, 1 + rng.bounded(param_));
+			break;
+
+		case PREFIX:
+		{
+			std::string prefix;
+			letters(prefix, param_);
+			for(auto &s : set) {
+				s = prefix;
+				letters(s, 1 + rng.bounded(16));
+			}
+			break;
+		}
+
+		case DICTIONARY:
+		{
+			static char const *const SUFFIXES[] = {
+				"", "", "s", "ed", "er", "ing", "ers", "ation", "ations", "ness"
+			};
+			std::vector<std::string> roots(param_);
+			for(auto &r : roots)
+				letters(r, 3 + rng.bounded(6));
+			for(auto &s : set) {
+				s = roots[rng.bounded(roots.size())];
+				if(rng.bounded(4) == 0)
+					s += "_" + roots[rng.bounded(roots.size())];
+				s += SUFFIXES[rng.bounded(sizeof SUFFIXES / sizeof *SUFFIXES)];
+			}
+			break;
+		}
+		}
+
+		std::sort(set.begin(), set.end());
+		return set;
+	}
+
+private:
+	Kind kind_;
+	unsigned long param_;
+
+};
+
+
+
+
+
+// struct
+struct StringArrayStruct
+{
+	typedef CString value_type;
+
+	CString *d;
+	unsigned int n;
+
+	uint64_t seed;
+	clever::Xoshiro256 rng;
+	Distribution distribution;
+	StringShape shape;
+};
+
+
+
+
+
+/*
+ * Data for arrays of strings. For every N a sorted set of N strings
+ * of the shape is made once; update() takes ranks from the
+ * distribution (random is a permutation of the set, duplicates:u
+ * are u strings of it and so on) and points elements to the strings
+ * of these ranks.
+ */
+template<>
+class Data<StringArrayStruct>: public StringArrayStruct
+{
+public:
+	typedef StringArrayStruct data_type;
+
+	Data():
+		StringArrayStruct{
+			nullptr, 1, 0, clever::Xoshiro256(), Distribution(), StringShape()
+		}
+	{
+		reseed(std::chrono::system_clock::now().time_since_epoch().count());
+		return;
+	}
+
+	Data(Data const &) = delete;
+	Data &operator=(Data const &) = delete;
+
+	Data &update()
+	{
+		if(lengths_.size() != n)
+			generate_();
+
+		distribution.fill(ranks_.data(), n, rng);
+		chars_ = 0;
+		for(unsigned int i = 0; i < n; ++i) {
+			size_t const r = ranks_[i] % n;
+			values_[i].s = pool_.data() + offsets_[r];
+			chars_ += lengths_[r];
+		}
+		d = values_.data();
+		return *this;
+	}
+
+	unsigned int getN() const
+	{
+		return n;
+	}
+
+	Data &next()
+	{
+		++n;
+		update();
+		return *this;
+	}
+
+	Data &reseed(uint64_t seed)
+	{
+		this->seed = seed;
+		rng.seed(seed);
+		return *this;
+	}
+
+	// characters in the strings of the current input
+	size_t getChars() const
+	{
+		return chars_;
+	}
+
+private:
+	void generate_()
+	{
+		std::vector<std::string> const set = shape.generate(n, rng);
+		pool_.clear();
+		offsets_.resize(n);
+		lengths_.resize(n);
+		for(unsigned int i = 0; i < n; ++i) {
+			offsets_[i] = pool_.size();
+			lengths_[i] = set[i].size();
+			pool_.insert(pool_.end(), set[i].begin(), set[i].end());
+			pool_.push_back(0);
+		}
+		ranks_.resize(n);
+		values_.resize(n);
+		return;
+	}
+
+
+
+	std::vector<unsigned char> pool_;
+	std::vector<size_t> offsets_, lengths_;
+	std::vector<unsigned int> ranks_;
+	std::vector<CString> values_;
+	size_t chars_ = 0;
+
+};
+
+
+
+typedef Data<StringArrayStruct> string_array_type;
+
+
+
+
+
+// end
+
+#endif
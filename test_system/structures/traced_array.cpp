@@ -0,0 +1,53 @@
+#include <algorithm>
+
+#include <clever/MemoryTrace.hpp>
+
+
+
+
+
+// struct
+// the same layout as RandomArrayStruct, but every element
+// reports its loads and stores to clever::MemoryTrace
+template<typename T>
+struct TracedArrayStruct
+{
+	typedef clever::Traced<T> value_type;
+
+	value_type *d;
+	unsigned int n;
+
+
+
+	TracedArrayStruct(): d(nullptr), n(0) {}
+	~TracedArrayStruct()
+	{
+		if(d)
+			delete[] d;
+		return;
+	}
+
+	TracedArrayStruct(TracedArrayStruct const &) = delete;
+	TracedArrayStruct &operator=(TracedArrayStruct const &) = delete;
+
+
+
+	// copy input from plain array (not traced)
+	TracedArrayStruct &assign(T const *b, unsigned int count)
+	{
+		if(count != n) {
+			if(d)
+				delete[] d;
+			n = count;
+			d = new value_type[n];
+		}
+		std::copy(b, b+count, d);
+		return *this;
+	}
+};
+
+
+
+
+
+// end
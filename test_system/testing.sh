@@ -1,16 +1,158 @@
 
+# result store, every run is also kept in ./results (see store.cpp)
+g++ -O2 -o store store.cpp
+
 # testing bubble sort
-g++ -O5 -I../lib -DBUBBLE_SORT -o bubble_sort main.cpp
+g++ -O5 -pthread -I../lib -DBUBBLE_SORT -o bubble_sort main.cpp
 bubble_sort ../chart_printer/bubble_sort.chart
+store add ../chart_printer/bubble_sort.chart bubble_sort
 
 # testing selection sort
-g++ -O5 -I../lib -DSELECTION_SORT -o selection_sort main.cpp
+g++ -O5 -pthread -I../lib -DSELECTION_SORT -o selection_sort main.cpp
 selection_sort ../chart_printer/selection_sort.chart
+store add ../chart_printer/selection_sort.chart selection_sort
 
 # testing insertion sort
-g++ -O5 -I../lib -DINSERTION_SORT -o insertion_sort main.cpp
+g++ -O5 -pthread -I../lib -DINSERTION_SORT -o insertion_sort main.cpp
 insertion_sort ../chart_printer/insertion_sort.chart
+store add ../chart_printer/insertion_sort.chart insertion_sort
 
 # testing merge sort
-g++ -O5 -I../lib -DMERGE_SORT -o merge_sort main.cpp
+g++ -O5 -pthread -I../lib -DMERGE_SORT -o merge_sort main.cpp
 merge_sort ../chart_printer/merge_sort.chart
+store add ../chart_printer/merge_sort.chart merge_sort
+
+# testing bottom-up merge sort, compare with merge sort
+g++ -O5 -pthread -I../lib -DPINGPONG_MERGE_SORT -o pingpong_merge_sort main.cpp
+pingpong_merge_sort ../chart_printer/pingpong_merge_sort.chart
+store add ../chart_printer/pingpong_merge_sort.chart pingpong_merge_sort
+
+# merge sort with branchless/AVX2 merge step
+g++ -O5 -pthread -I../lib -DKERNEL_MERGE_SORT -o kernel_merge_sort main.cpp
+kernel_merge_sort ../chart_printer/kernel_merge_sort.chart
+store add ../chart_printer/kernel_merge_sort.chart kernel_merge_sort
+
+# sorting networks: small arrays alone, compare with insertion sort,
+# and as blocks of merge sort, compare with merge sort
+g++ -O5 -pthread -I../lib -DNETWORK_SORT -o network_sort main.cpp
+network_sort ../chart_printer/network_sort.chart --maxn=64 --repeat=1000
+store add ../chart_printer/network_sort.chart network_sort
+
+g++ -O5 -pthread -I../lib -DNETWORK_MERGE_SORT -o network_merge_sort main.cpp
+network_merge_sort ../chart_printer/network_merge_sort.chart
+store add ../chart_printer/network_merge_sort.chart network_merge_sort
+
+# radix sorts, compare with merge sort
+for RADIX in radix_sort radix11_sort; do
+	g++ -O5 -pthread -I../lib -D${RADIX^^} -o $RADIX main.cpp
+	$RADIX ../chart_printer/$RADIX.chart
+	store add ../chart_printer/$RADIX.chart $RADIX
+done
+
+# pattern-defeating quicksort against standard library sorts
+for SORT in pdq_sort std_sort std_stable_sort; do
+	g++ -O5 -pthread -I../lib -D${SORT^^} -o $SORT main.cpp
+	$SORT ../chart_printer/$SORT.chart
+	store add ../chart_printer/$SORT.chart $SORT
+done
+
+# stable block merge sorts without n-element buffer, compare with
+# merge sort; peak extra memory is measured with samplesort below
+for SORT in grail_sort grail_cache_sort; do
+	g++ -O5 -pthread -I../lib -D${SORT^^} -o $SORT main.cpp
+	$SORT ../chart_printer/$SORT.chart
+	store add ../chart_printer/$SORT.chart $SORT
+done
+
+# adaptive natural merge sort against merge sort over presortedness:
+# sorted and reversed input, then heatmaps over the number of runs
+# and of random swaps in sorted input
+g++ -O5 -pthread -I../lib -DPOWER_SORT -o power_sort main.cpp
+power_sort ../chart_printer/power_sort.chart
+store add ../chart_printer/power_sort.chart power_sort
+for SORT in power_sort merge_sort; do
+	for DIST in sorted reversed; do
+		$SORT ../chart_printer/${SORT}_$DIST.chart --distribution=$DIST
+		store add ../chart_printer/${SORT}_$DIST.chart $SORT $DIST
+	done
+	$SORT ../chart_printer/${SORT}_runs.matrix --maxn=4096 --distribution=runs --grid=1,4,16,64,256,1024
+	$SORT ../chart_printer/${SORT}_nearly_sorted.matrix --maxn=4096 --distribution=nearly_sorted --grid=0,4,16,64,256,1024
+done
+
+# direct against indirect sorting over record sizes: break-even size
+# of payload, for an unstable and a stable engine
+for ELEMENT in int64_t record16 record32 record64 record128 record256 record512 record1024; do
+	for SORT in pdq_sort indirect_pdq_sort indirect_pdq_cycle_sort radix_sort indirect_radix_sort indirect_radix_cycle_sort; do
+		g++ -O5 -pthread -I../lib -D${SORT^^} -DELEMENT_TYPE=$ELEMENT -o ${SORT}_$ELEMENT main.cpp
+		${SORT}_$ELEMENT ../chart_printer/${SORT}_$ELEMENT.chart
+		store add ../chart_printer/${SORT}_$ELEMENT.chart $SORT
+	done
+done
+
+# parallel merge sort, speedup and efficiency against merge sort
+# are written next to the chart; N grows by one, so the cutoff is lowered
+g++ -O5 -pthread -I../lib -DPARALLEL_MERGE_SORT -o parallel_merge_sort main.cpp
+parallel_merge_sort ../chart_printer/parallel_merge_sort.chart --cutoff=256
+store add ../chart_printer/parallel_merge_sort.chart parallel_merge_sort
+
+# in-place parallel samplesort: time with speedup, then peak extra
+# memory of in-place sorts against merge sort
+g++ -O5 -pthread -I../lib -DSAMPLE_SORT -o sample_sort main.cpp
+sample_sort ../chart_printer/sample_sort.chart --maxn=16384 --repeat=3 --cutoff=4096
+store add ../chart_printer/sample_sort.chart sample_sort
+for SORT in sample_sort grail_sort grail_cache_sort merge_sort; do
+	g++ -O5 -pthread -I../lib -D${SORT^^} -DMEMORY_TRACE -o ${SORT}_memory main.cpp
+	${SORT}_memory ../chart_printer/${SORT}_memory.chart --maxn=16384 --repeat=3
+done
+
+# selection and top-k: the median first, then heatmaps over N and k
+# (number of smallest elements); sort_top_k sorts all, the reference
+for SELECT in quick_select intro_select floyd_rivest_select median_of_medians_select std_nth_element heap_top_k partial_quick_sort std_partial_sort sort_top_k; do
+	g++ -O5 -pthread -I../lib -D${SELECT^^} -o $SELECT main.cpp
+	$SELECT ../chart_printer/$SELECT.chart --k=0.5
+	store add ../chart_printer/$SELECT.chart $SELECT
+	$SELECT ../chart_printer/$SELECT.matrix --maxn=4096 --grid=1,4,16,64,256,1024,4096
+done
+
+# string sorts against comparison sorts on random strings, URL-like
+# strings with a long shared prefix and identifiers; elements and
+# characters per second are written next to the charts
+for STRINGS in random prefix:64 dictionary; do
+	for SORT in msd_radix_sort multikey_quick_sort lcp_merge_sort string_std_sort string_pdq_sort; do
+		CHART=../chart_printer/${SORT}_${STRINGS%%:*}.chart
+		g++ -O5 -pthread -I../lib -D${SORT^^} -o $SORT main.cpp
+		$SORT $CHART --strings=$STRINGS
+		store add $CHART $SORT
+	done
+done
+
+# inlined comparator against the same sort calling it through
+# a pointer, as qsort does (FunctionCompare in sort/compare.cpp)
+for SORT in insertion_sort merge_sort pdq_sort power_sort grail_sort; do
+	for VARIANT in $SORT ${SORT}_function_compare; do
+		g++ -O5 -pthread -I../lib -D${VARIANT^^} -o $VARIANT main.cpp
+		$VARIANT ../chart_printer/$VARIANT.chart
+		store add ../chart_printer/$VARIANT.chart $VARIANT
+	done
+done
+
+# merge kernels alone, input is two sorted halves
+for KERNEL in goto_merge_kernel branchless_merge_kernel simd_merge_kernel; do
+	g++ -O5 -pthread -I../lib -D${KERNEL^^} -o $KERNEL main.cpp
+	$KERNEL ../chart_printer/$KERNEL.chart --distribution=runs:2
+	store add ../chart_printer/$KERNEL.chart $KERNEL runs:2
+done
+
+# testing list sorts, nodes in random order
+g++ -O5 -pthread -I../lib -DLIST_INSERTION_SORT -o list_insertion_sort main.cpp
+list_insertion_sort ../chart_printer/list_insertion_sort.chart --layout=shuffled
+store add ../chart_printer/list_insertion_sort.chart list_insertion_sort
+
+g++ -O5 -pthread -I../lib -DLIST_MERGE_SORT -o list_merge_sort main.cpp
+list_merge_sort ../chart_printer/list_merge_sort.chart --layout=shuffled
+store add ../chart_printer/list_merge_sort.chart list_merge_sort
+
+# insertion sort against merge sort over N and number of distinct keys,
+# heatmap of their ratio: see chart_printer/config
+insertion_sort ../chart_printer/insertion_sort.matrix --maxn=256 --distribution=duplicates --grid=1,2,4,8,16,64,256
+merge_sort ../chart_printer/merge_sort.matrix --maxn=256 --distribution=duplicates --grid=1,2,4,8,16,64,256
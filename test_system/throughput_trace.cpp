@@ -0,0 +1,72 @@
+#include <fstream>
+#include <memory>
+#include <string>
+
+
+
+
+
+/*
+ * Throughput trace mode (string sorts, see main.cpp).
+ *
+ * Time of one run is the time chart point divided by the number
+ * of counted runs (repeat minus minimum and maximum). Two charts
+ * are written next to the time chart:
+ *
+ *         "<output>.elements.chart"       - elements per second
+ *         "<output>.chars.chart"          - characters per second,
+ *                                           by characters of the last input
+ */
+class ThroughputTrace
+{
+public:
+	void open(std::string const &outfilename)
+	{
+		elements_.reset(new std::ofstream(
+			outfilename + ".elements.chart", std::ofstream::binary
+		));
+		chars_.reset(new std::ofstream(
+			outfilename + ".chars.chart", std::ofstream::binary
+		));
+		return;
+	}
+
+	bool good() const
+	{
+		return elements_ && *elements_ && chars_ && *chars_;
+	}
+
+
+	// time - microseconds of repeatcount-2 runs for this N
+	template<typename DataType>
+	void measure(DataType const &data, size_t repeatcount, double time)
+	{
+		double const seconds = time * 1e-6 / (repeatcount - 2);
+		float const x = (float)data.getN();
+		write_point_(*elements_, x, seconds > 0 ? float(data.getN() / seconds) : 0.f);
+		write_point_(*chars_, x, seconds > 0 ? float(data.getChars() / seconds) : 0.f);
+		return;
+	}
+
+private:
+	static void write_point_(std::ostream &os, float x, float y)
+	{
+		os.write( (char const *)&x, sizeof x );
+		os.write( (char const *)&y, sizeof y );
+		return;
+	}
+
+
+
+	std::unique_ptr<std::ofstream> elements_, chars_;
+
+};
+
+
+ThroughputTrace throughput_trace;
+
+
+
+
+
+// end
@@ -0,0 +1,41 @@
+#!/bin/bash
+
+# every algorithm under every build variant from file "variants",
+# results go to the store tagged with variant (see store.cpp)
+#
+#         variants.sh [maxn] [repeat] [reference variant]
+
+MAXN=${1:-1024}
+REPEAT=${2:-20}
+REFERENCE=${3:-O2}
+ALGORITHMS="bubble_sort selection_sort insertion_sort merge_sort pingpong_merge_sort kernel_merge_sort network_merge_sort radix_sort radix11_sort pdq_sort std_sort std_stable_sort grail_sort grail_cache_sort power_sort insertion_sort_function_compare merge_sort_function_compare pdq_sort_function_compare power_sort_function_compare grail_sort_function_compare indirect_pdq_sort indirect_pdq_cycle_sort indirect_radix_sort indirect_radix_cycle_sort parallel_merge_sort sample_sort"
+
+g++ -O2 -o store store.cpp || exit 1
+
+grep -v '^#' variants | while read NAME COMPILER FLAGS; do
+	[ -z "$NAME" ] && continue
+	if ! command -v $COMPILER > /dev/null; then
+		echo "skip $NAME: $COMPILER not found"
+		continue
+	fi
+
+	mkdir -p build/$NAME
+	for ALG in $ALGORITHMS; do
+		BIN=build/$NAME/$ALG
+		BUILD="$COMPILER -pthread -I../lib -D${ALG^^} -o $BIN main.cpp"
+		TAGS=(-DBUILD_VARIANT="\"$NAME\"" -DBUILD_FLAGS="\"$COMPILER $FLAGS\"")
+
+		# profile guided: training run on a short schedule
+		if [[ "$FLAGS" == *-fprofile-use* ]]; then
+			$BUILD ${FLAGS//-fprofile-use/-fprofile-generate} "${TAGS[@]}" || continue
+			$BIN $BIN.chart --maxn=$((MAXN / 4 + 1)) --repeat=5 > /dev/null || continue
+		fi
+
+		echo "$NAME: $ALG"
+		$BUILD $FLAGS "${TAGS[@]}" || continue
+		$BIN $BIN.chart --maxn=$MAXN --repeat=$REPEAT > /dev/null || continue
+		./store add $BIN.chart $ALG random --variant=$NAME > /dev/null
+	done
+done
+
+./store compare --reference=$REFERENCE --host=this --distribution=random